@@ -0,0 +1,506 @@
+/* Benchmarks the kernels of the library across problem sizes
+ *
+ * Every (kernel, size) pair is called repeatedly until it has run for
+ * at least the minimal time, then one JSON object per line is written:
+ *   {"kernel": ..., "size": ..., "calls": ..., "seconds": ...,
+ *    "ns_per_call": ..., "work_per_call": ..., "work_unit": ...,
+ *    "work_per_sec": ...}
+ * work is the number of integrand / right-hand side evaluations for
+ * the calculus kernels and an operation count for the linear algebra.
+ *
+ * Usage: bench [-t min_seconds] [-k kernel_substring] [-o output]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "numerical.h"
+
+/* evaluations of the counting integrands below, single threaded only */
+static long nevals;
+
+static double sin_count(double x)
+{
+	nevals++;
+	return sin(x);
+}
+
+static double inv_count(double x, double y)
+{
+	nevals++;
+	return 1.0 / (x + y);
+}
+
+static double peak_count(double x)
+{
+	nevals++;
+	return 1.0 / ((x - 0.3) * (x - 0.3) + 1e-4);
+}
+
+static double cubic(double x)
+{
+	nevals++;
+	return x * x * x / 3.0 - x;
+}
+
+static double cubic_prime(double x)
+{
+	nevals++;
+	return x * x - 1.0;
+}
+
+static double ode_rhs(double x, double y)
+{
+	nevals++;
+	return - x * x * y * y;
+}
+
+static long double runge(long double x)
+{
+	return 1.0 / (1.0 + x * x);
+}
+
+static void g_vec(int n, int dim, const double x[], double y[], void *data)
+{
+	double p;
+	int i, j;
+
+	for (i = 0; i < n; i++) {
+		p = 1.0;
+		for (j = 0; j < dim; j++)
+			p *= (fabs(4.0 * x[i*dim + j] - 2.0) + j + 1) / (j + 2);
+		y[i] = p;
+	}
+	nevals += n;
+}
+
+/*
+ * Cheap parametrized functions, once through a plain function pointer
+ * with the parameters in a global and once through the inlined _ctx
+ * solvers with the parameters in the context.
+ */
+struct poly {
+	double c0, c1, c2;
+};
+
+static struct poly poly_params = {1.0, -0.5, 0.25};
+
+static double poly_global(double x)
+{
+	return poly_params.c0 + x * (poly_params.c1 + x * poly_params.c2);
+}
+
+static double poly_ctx(double x, void *ctx)
+{
+	const struct poly *p = ctx;
+
+	return p->c0 + x * (p->c1 + x * p->c2);
+}
+
+static double poly_prime_global(double x)
+{
+	return poly_params.c1 + 2.0 * x * poly_params.c2;
+}
+
+static double poly_prime_ctx(double x, void *ctx)
+{
+	const struct poly *p = ctx;
+
+	return p->c1 + 2.0 * x * p->c2;
+}
+
+static double decay_rate = 0.7;
+
+static double decay_global(double x, double y)
+{
+	return - decay_rate * y + x;
+}
+
+static double decay_ctx(double x, double y, void *ctx)
+{
+	return - *(double *) ctx * y + x;
+}
+
+/*
+ * Linear systems: diagonally dominant random matrices, regenerated only
+ * when the size changes.  The solvers overwrite their inputs, so every
+ * call starts from a copy.
+ */
+static double *sys_A, *sys_Ab, *sys_work, *sys_Y, *sys_X;
+static long sys_n;
+
+static void sys_setup(long n)
+{
+	long i, j;
+	double s;
+
+	if (sys_n == n)
+		return;
+	free(sys_A);
+	free(sys_Ab);
+	free(sys_work);
+	free(sys_Y);
+	free(sys_X);
+	sys_A = malloc(n * n * sizeof(double));
+	sys_Ab = malloc(n * (n + 1) * sizeof(double));
+	sys_work = malloc(n * (n + 1) * sizeof(double));
+	sys_Y = malloc(n * sizeof(double));
+	sys_X = malloc(n * sizeof(double));
+	if (sys_A == NULL || sys_Ab == NULL || sys_work == NULL
+	    || sys_Y == NULL || sys_X == NULL) {
+		fprintf(stderr, "out of memory for n = %ld\n", n);
+		exit(1);
+	}
+	srand(1);
+	for (i = 0; i < n; i++) {
+		s = 0.0;
+		for (j = 0; j < n; j++) {
+			sys_A[i*n + j] = (double) rand() / RAND_MAX - 0.5;
+			s += fabs(sys_A[i*n + j]);
+		}
+		sys_A[i*n + i] = s + 1.0;
+		sys_Y[i] = (double) rand() / RAND_MAX;
+		for (j = 0; j < n; j++)
+			sys_Ab[i*(n+1) + j] = sys_A[i*n + j];
+		sys_Ab[i*(n+1) + n] = sys_Y[i];
+	}
+	sys_n = n;
+}
+
+static double run_colmaj(long n)
+{
+	sys_setup(n);
+	memcpy(sys_work, sys_Ab, n * (n + 1) * sizeof(double));
+	lsolve_colmaj(sys_work, sys_X, n);
+	return 2.0 * n * n * n / 3.0;
+}
+
+static double run_sor(long n)
+{
+	int nstep;
+
+	sys_setup(n);
+	memset(sys_X, 0, n * sizeof(double));
+	lsolve_sor(sys_A, sys_Y, sys_X, 1.2, n, 1e-10, &nstep);
+	return 2.0 * n * n * nstep;
+}
+
+/* residual test on every 4th sweep, each test costs another sweep */
+static double run_sor_check(long n)
+{
+	int nstep;
+
+	sys_setup(n);
+	memset(sys_X, 0, n * sizeof(double));
+	lsolve_sor_check(sys_A, sys_Y, sys_X, 1.2, n, 0, 1e-10, 4, &nstep);
+	return 2.0 * n * n * (nstep + nstep / 4);
+}
+
+static double run_newton(long n)
+{
+	int nr_iter;
+
+	nevals = 0;
+	nsolve_newton(cubic, cubic_prime, 9.0, 1e-13, &nr_iter);
+	return nevals;
+}
+
+static double run_secant(long n)
+{
+	int nr_iter;
+
+	nevals = 0;
+	nsolve_secant(cubic, 8.0, 9.0, 1e-13, &nr_iter);
+	return nevals;
+}
+
+static double run_runge(long n)
+{
+	nevals = 0;
+	ndsolve_runge(ode_rhs, 0, 1.5, 1.5 / n, 3);
+	return nevals;
+}
+
+static double run_adams(long n)
+{
+	nevals = 0;
+	ndsolve_adams(ode_rhs, 0, 1.5, 1.5 / n, 3);
+	return nevals;
+}
+
+static double run_lagrange(long n)
+{
+	long double vx[n+1], vy[n+1];
+	volatile long double sink;
+	int i, j;
+
+	for (i = 0; i <= n; i++) {
+		vx[i] = -5.0 + 10.0 * i / n;
+		vy[i] = runge(vx[i]);
+	}
+	for (j = 0; j <= 100; j++)
+		sink = lagrange_interpolate(-5.0 + 0.1 * j, n, vx, vy);
+	(void) sink;
+	return 101.0 * (n + 1) * (n + 1);
+}
+
+static double run_psi(long n)
+{
+	static double *x, *res;
+	static long size;
+	long i;
+
+	if (size != n) {
+		free(x);
+		free(res);
+		x = malloc(n * sizeof(*x));
+		res = malloc(n * sizeof(*res));
+		if (x == NULL || res == NULL) {
+			fprintf(stderr, "out of memory for n = %ld\n", n);
+			exit(1);
+		}
+		for (i = 0; i < n; i++)
+			x[i] = 300.0 * i / n;
+		size = n;
+	}
+	get_psi_batch(n, x, res, 1);
+	return n;
+}
+
+static double run_simpson_poly(long n)
+{
+	volatile double sink;
+
+	sink = nintegrate_simpson(poly_global, 1.0, 5.0, n);
+	(void) sink;
+	return n + 1;
+}
+
+static double run_simpson_poly_ctx(long n)
+{
+	struct poly p = poly_params;
+	volatile double sink;
+
+	sink = nintegrate_simpson_ctx(poly_ctx, &p, 1.0, 5.0, n);
+	(void) sink;
+	return n + 1;
+}
+
+static double run_newton_poly(long n)
+{
+	volatile double sink;
+	int nr_iter;
+
+	/* c0 = -1 gives the root 2 */
+	poly_params.c0 = -1.0;
+	sink = nsolve_newton(poly_global, poly_prime_global, 9.0, 1e-13,
+			     &nr_iter);
+	poly_params.c0 = 1.0;
+	(void) sink;
+	return 2.0 * nr_iter;
+}
+
+static double run_newton_poly_ctx(long n)
+{
+	struct poly p = {-1.0, poly_params.c1, poly_params.c2};
+	volatile double sink;
+	int nr_iter;
+
+	sink = nsolve_newton_ctx(poly_ctx, poly_prime_ctx, &p, 9.0, 1e-13,
+				 &nr_iter);
+	(void) sink;
+	return 2.0 * nr_iter;
+}
+
+static double run_runge_decay(long n)
+{
+	volatile double sink;
+
+	sink = ndsolve_runge(decay_global, 0, 1.5, 1.5 / n, 3);
+	(void) sink;
+	return 4.0 * n;
+}
+
+static double run_runge_decay_ctx(long n)
+{
+	double rate = decay_rate;
+	volatile double sink;
+
+	sink = ndsolve_runge_ctx(decay_ctx, &rate, 0, 1.5, 1.5 / n, 3);
+	(void) sink;
+	return 4.0 * n;
+}
+
+static double run_trapezodial(long n)
+{
+	nevals = 0;
+	nintegrate_trapezodial(sin_count, 1.0, 5.0, n);
+	return nevals;
+}
+
+static double run_simpson(long n)
+{
+	nevals = 0;
+	nintegrate_simpson(sin_count, 1.0, 5.0, n);
+	return nevals;
+}
+
+static double run_simpson_2d(long n)
+{
+	nevals = 0;
+	nintegrate_2d(inv_count, 1, 5, n, 1, 5, n, NINTEGRATE_SIMPSON, 1);
+	return nevals;
+}
+
+static double run_romberg(long n)
+{
+	nevals = 0;
+	nintegrate_romberg(sin_count, 1.0, 5.0, pow(10.0, -n),
+			   ROMBERG_MAXLEVEL, NULL, NULL);
+	return nevals;
+}
+
+static double run_gk(long n)
+{
+	nevals = 0;
+	nintegrate_gk(peak_count, 0.0, 1.0, GK21, pow(10.0, -n), 0.0,
+		      10000, 1, NULL, NULL);
+	return nevals;
+}
+
+static double run_gk_ws(long n)
+{
+	static struct workspace ws;
+
+	if (ws.base == NULL)
+		workspace_init(&ws, nintegrate_gk_workspace(10000, 1));
+	nevals = 0;
+	nintegrate_gk_vec_ws(vec_scalar, &(double (*)(double)) {peak_count},
+			     0.0, 1.0, GK21, pow(10.0, -n), 0.0, 10000, 1,
+			     NULL, NULL, &ws);
+	return nevals;
+}
+
+static double run_gl_2d(long n)
+{
+	nevals = 0;
+	nintegrate_gl_2d(inv_count, 1, 5, 1, 1, 5, 1, n);
+	return nevals;
+}
+
+static double run_mc(long n)
+{
+	double a[8] = {0}, b[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+	nevals = 0;
+	nintegrate_mc_vec(g_vec, NULL, 8, a, b, n, 8, MC_SOBOL, 1, 1, NULL);
+	return nevals;
+}
+
+static const struct bench {
+	const char *name;
+	const char *unit;
+	double (*run)(long size);
+	long sizes[4];		/* 0 terminated */
+} benches[] = {
+	{"lsolve_colmaj", "flops", run_colmaj, {16, 64, 256}},
+	{"lsolve_sor", "flops", run_sor, {16, 64, 256}},
+	{"lsolve_sor_check", "flops", run_sor_check, {16, 64, 256}},
+	{"nsolve_newton", "evals", run_newton, {1}},
+	{"nsolve_secant", "evals", run_secant, {1}},
+	{"ndsolve_runge", "evals", run_runge, {100, 1000, 10000}},
+	{"ndsolve_adams", "evals", run_adams, {100, 1000, 10000}},
+	{"lagrange_interpolate", "flops", run_lagrange, {5, 20, 80}},
+	{"get_psi_batch", "evals", run_psi, {64, 4096, 262144}},
+	{"nintegrate_trapezodial", "evals", run_trapezodial,
+	 {256, 4096, 65536}},
+	{"nintegrate_simpson", "evals", run_simpson, {256, 4096, 65536}},
+	{"nintegrate_simpson_poly", "evals", run_simpson_poly,
+	 {256, 4096, 65536}},
+	{"nintegrate_simpson_poly_ctx", "evals", run_simpson_poly_ctx,
+	 {256, 4096, 65536}},
+	{"nsolve_newton_poly", "evals", run_newton_poly, {1}},
+	{"nsolve_newton_poly_ctx", "evals", run_newton_poly_ctx, {1}},
+	{"ndsolve_runge_decay", "evals", run_runge_decay, {100, 1000, 10000}},
+	{"ndsolve_runge_decay_ctx", "evals", run_runge_decay_ctx,
+	 {100, 1000, 10000}},
+	{"nintegrate_simpson_2d", "evals", run_simpson_2d, {64, 512, 2048}},
+	{"nintegrate_romberg", "evals", run_romberg, {6, 10, 13}},
+	{"nintegrate_gk", "evals", run_gk, {6, 10}},
+	{"nintegrate_gk_ws", "evals", run_gk_ws, {6, 10}},
+	{"nintegrate_gl_2d", "evals", run_gl_2d, {8, 16, 32}},
+	{"nintegrate_mc_sobol_8d", "evals", run_mc, {1024, 16384, 262144}},
+};
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+	const struct bench *b;
+	const char *filter = NULL;
+	FILE *out = stdout;
+	double min_time = 0.1, start, elapsed, work;
+	long calls, c;
+	int opt, k;
+
+	while ((opt = getopt(argc, argv, "t:k:o:")) != -1) {
+		switch (opt) {
+		case 't':
+			min_time = atof(optarg);
+			break;
+		case 'k':
+			filter = optarg;
+			break;
+		case 'o':
+			out = fopen(optarg, "w");
+			if (out == NULL) {
+				perror(optarg);
+				return 1;
+			}
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-t min_seconds] "
+				"[-k kernel_substring] [-o output]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for (b = benches; b < benches + sizeof(benches)/sizeof(*benches); b++) {
+		if (filter != NULL && strstr(b->name, filter) == NULL)
+			continue;
+		for (k = 0; k < 4 && b->sizes[k] != 0; k++) {
+			work = b->run(b->sizes[k]);	/* warm up */
+			for (calls = 1; ; calls *= 2) {
+				start = now();
+				for (c = 0; c < calls; c++)
+					b->run(b->sizes[k]);
+				elapsed = now() - start;
+				if (elapsed >= min_time)
+					break;
+			}
+			fprintf(out, "{\"kernel\": \"%s\", \"size\": %ld, "
+				"\"calls\": %ld, \"seconds\": %.9g, "
+				"\"ns_per_call\": %.6g, "
+				"\"work_per_call\": %.6g, "
+				"\"work_unit\": \"%s\", "
+				"\"work_per_sec\": %.6g}\n",
+				b->name, b->sizes[k], calls, elapsed,
+				elapsed / calls * 1e9, work, b->unit,
+				work * calls / elapsed);
+			fflush(out);
+		}
+	}
+	if (out != stdout)
+		fclose(out);
+
+	return 0;
+}
@@ -0,0 +1,33 @@
+/* Callbacks with a context pointer for the header-only solvers
+ *
+ * The _ctx variant of a solver is a static inline function in the
+ * solver's header that calls f(..., ctx) instead of a plain function
+ * pointer.  @ctx carries whatever parameters the function needs, so a
+ * parametrized function does not have to go through globals.  When the
+ * solver is called with the address of a function visible in the same
+ * translation unit, the solver is inlined at the call site, the call
+ * through the pointer becomes a direct call, and the compiler can inline
+ * the function into the loop of the solver.
+ */
+
+#ifndef CALLBACK_H
+#define CALLBACK_H
+
+/* inlining the solver is what lets the callback be inlined in turn */
+#define CB_INLINE	static inline __attribute__((always_inline))
+
+/*
+ * Adapters for plain function pointers: pass cb_scalar as the function
+ * and the address of the function pointer as @ctx.
+ */
+static inline double cb_scalar(double x, void *ctx)
+{
+	return (*(double (**)(double)) ctx)(x);
+}
+
+static inline double cb_scalar_2d(double x, double y, void *ctx)
+{
+	return (*(double (**)(double, double)) ctx)(x, y);
+}
+
+#endif /* CALLBACK_H */
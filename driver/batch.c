@@ -0,0 +1,762 @@
+/* Solves a stream of problems and writes the results as binary records
+ *
+ * Reads one problem per line from a file, which is memory-mapped, or
+ * from stdin:
+ *   linear N a11 a12 ... aNN y1 ... yN	AX = Y, Gauss elimination
+ *   root x0 x1 eps EXPR			f(x) = 0, secant method
+ *   integrate a b eps EXPR		integral of f(x), adaptive GK21
+ *   ivp a b h y0 EXPR			y(b) for y' = f(x, y), Runge-Kutta
+ * The numbers before EXPR must be finite, and an ivp needs a <= b,
+ * h > 0 and at most BATCH_MAXSTEPS steps.  Blank lines and lines
+ * starting with '#' are skipped.  EXPR is f in reverse Polish notation
+ * over x and y, e.g. "x x * 2 -" is x^2 - 2:
+ *   numbers, x, y, pi, + - * / ^, neg abs sqrt exp log sin cos tan
+ *
+ * The main thread parses, a pool of threads solves and another thread
+ * writes, so reading, solving and writing overlap.  Up to BATCH_DEPTH
+ * problems are in flight; records come out in input order.
+ *
+ * Output, native byte order: the 8 bytes "NUMBAT1\0", then per problem
+ * a struct batch_record followed by @n doubles:
+ *   linear	X
+ *   root	root
+ *   integrate	integral, error estimate
+ *   ivp	y(b)
+ * A record with a nonzero status may carry fewer values than that.
+ *
+ * Usage: batch [-j threads] [-o output] [input]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "numerical.h"
+
+#define BATCH_MAGIC	"NUMBAT1"
+#define BATCH_DEPTH	256	/* problems in flight */
+#define BATCH_GK_LIMIT	200	/* subintervals per integral */
+#define BATCH_MAXN	4096	/* unknowns of a linear system */
+#define BATCH_MAXSTEPS	100000000	/* Runge-Kutta steps of an IVP */
+
+#define EXPR_MAXOPS	64
+#define EXPR_MAXSTACK	16
+
+enum problem_kind {
+	PROBLEM_INVALID = -1,	/* unknown problem, only in EPARSE records */
+	PROBLEM_LINEAR,
+	PROBLEM_ROOT,
+	PROBLEM_INTEGRATE,
+	PROBLEM_IVP,
+};
+
+enum batch_status {
+	BATCH_OK,
+	BATCH_EPARSE,		/* malformed line, nothing solved */
+	BATCH_ESOLVE,		/* no convergence or a non-finite result */
+	BATCH_ENOMEM,
+};
+
+struct batch_record {
+	uint64_t seq;		/* problem number in the input, from 0 */
+	int32_t kind;		/* enum problem_kind */
+	int32_t status;		/* enum batch_status */
+	int32_t iters;		/* iterations, steps or evaluations */
+	uint32_t n;		/* doubles following */
+};
+
+enum expr_op {
+	OP_NUM, OP_X, OP_Y,
+	OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+	OP_NEG, OP_ABS, OP_SQRT, OP_EXP, OP_LOG, OP_SIN, OP_COS, OP_TAN,
+};
+
+struct expr {
+	int nops;
+	enum expr_op op[EXPR_MAXOPS];
+	double num[EXPR_MAXOPS];
+};
+
+struct problem {
+	enum problem_kind kind;
+	enum batch_status status;
+	long seq;
+	int n;
+	double arg[4];
+	struct expr expr;
+	double *mat;		/* (A|Y) of a linear system */
+	size_t matcap;
+	int iters;
+	int nres;
+	double *res;
+	size_t rescap;
+	int done;
+};
+
+struct batch {
+	pthread_mutex_t lock;
+	pthread_cond_t ready;	/* a problem to solve or end of input */
+	pthread_cond_t done;	/* a result to write or end of input */
+	pthread_cond_t free;	/* a slot to read into */
+	struct problem slot[BATCH_DEPTH];
+	long nread, nsolved, nwritten;
+	int eof;
+	FILE *out;
+	int werr;
+};
+
+static const struct {
+	const char *name;
+	enum expr_op op;
+	int pop;		/* operands taken from the stack */
+} expr_words[] = {
+	{"x", OP_X, 0}, {"y", OP_Y, 0},
+	{"+", OP_ADD, 2}, {"-", OP_SUB, 2}, {"*", OP_MUL, 2},
+	{"/", OP_DIV, 2}, {"^", OP_POW, 2},
+	{"neg", OP_NEG, 1}, {"abs", OP_ABS, 1}, {"sqrt", OP_SQRT, 1},
+	{"exp", OP_EXP, 1}, {"log", OP_LOG, 1}, {"sin", OP_SIN, 1},
+	{"cos", OP_COS, 1}, {"tan", OP_TAN, 1},
+};
+
+static const char *const problem_names[] = {
+	[PROBLEM_LINEAR] = "linear",
+	[PROBLEM_ROOT] = "root",
+	[PROBLEM_INTEGRATE] = "integrate",
+	[PROBLEM_IVP] = "ivp",
+};
+
+/* a line, or the rest of it, not NUL-terminated */
+struct cursor {
+	const char *p, *end;
+};
+
+/*
+ * copies the next word into @tok, returns its length, 0 at the end, -1
+ * if it does not fit (@tok then holds its beginning)
+ */
+static int next_word(struct cursor *c, char *tok, int size)
+{
+	int len = 0;
+
+	while (c->p < c->end && (*c->p == ' ' || *c->p == '\t'
+				 || *c->p == '\r'))
+		c->p++;
+	while (c->p < c->end && *c->p != ' ' && *c->p != '\t'
+	       && *c->p != '\r') {
+		if (len < size - 1)
+			tok[len] = *c->p;
+		len++;
+		c->p++;
+	}
+	if (len >= size) {
+		tok[size-1] = '\0';
+		return -1;
+	}
+	tok[len] = '\0';
+	return len;
+}
+
+static int parse_number(const char *tok, double *v)
+{
+	char *end;
+
+	errno = 0;
+	*v = strtod(tok, &end);
+	return end == tok || *end != '\0' || errno == ERANGE ? -1 : 0;
+}
+
+static int next_number(struct cursor *c, double *v)
+{
+	char tok[64];
+
+	if (next_word(c, tok, sizeof(tok)) <= 0)
+		return -1;
+	return parse_number(tok, v);
+}
+
+/* compiles the rest of the line, checking the stack depth on the way */
+static int parse_expr(struct cursor *c, struct expr *e)
+{
+	char tok[64];
+	int i, len, depth = 0, pop;
+
+	e->nops = 0;
+	while ((len = next_word(c, tok, sizeof(tok))) != 0) {
+		if (len < 0 || e->nops == EXPR_MAXOPS)
+			return -1;
+		pop = -1;
+		for (i = 0; i < sizeof(expr_words)/sizeof(*expr_words); i++) {
+			if (strcmp(tok, expr_words[i].name) == 0) {
+				e->op[e->nops] = expr_words[i].op;
+				pop = expr_words[i].pop;
+				break;
+			}
+		}
+		if (pop < 0) {
+			e->op[e->nops] = OP_NUM;
+			pop = 0;
+			if (strcmp(tok, "pi") == 0)
+				e->num[e->nops] = M_PI;
+			else if (parse_number(tok, &e->num[e->nops]))
+				return -1;
+		}
+		if (depth < pop)
+			return -1;
+		depth += 1 - pop;
+		if (depth > EXPR_MAXSTACK)
+			return -1;
+		e->nops++;
+	}
+	return depth == 1 ? 0 : -1;
+}
+
+static double expr_eval(const struct expr *e, double x, double y)
+{
+	double st[EXPR_MAXSTACK];
+	int i, sp = 0;
+
+	for (i = 0; i < e->nops; i++) {
+		switch (e->op[i]) {
+		case OP_NUM:	st[sp++] = e->num[i]; break;
+		case OP_X:	st[sp++] = x; break;
+		case OP_Y:	st[sp++] = y; break;
+		case OP_ADD:	sp--; st[sp-1] += st[sp]; break;
+		case OP_SUB:	sp--; st[sp-1] -= st[sp]; break;
+		case OP_MUL:	sp--; st[sp-1] *= st[sp]; break;
+		case OP_DIV:	sp--; st[sp-1] /= st[sp]; break;
+		case OP_POW:	sp--; st[sp-1] = pow(st[sp-1], st[sp]); break;
+		case OP_NEG:	st[sp-1] = -st[sp-1]; break;
+		case OP_ABS:	st[sp-1] = fabs(st[sp-1]); break;
+		case OP_SQRT:	st[sp-1] = sqrt(st[sp-1]); break;
+		case OP_EXP:	st[sp-1] = exp(st[sp-1]); break;
+		case OP_LOG:	st[sp-1] = log(st[sp-1]); break;
+		case OP_SIN:	st[sp-1] = sin(st[sp-1]); break;
+		case OP_COS:	st[sp-1] = cos(st[sp-1]); break;
+		case OP_TAN:	st[sp-1] = tan(st[sp-1]); break;
+		}
+	}
+	return st[0];
+}
+
+static double expr_fx(double x, void *ctx)
+{
+	return expr_eval(ctx, x, 0.0);
+}
+
+static double expr_fxy(double x, double y, void *ctx)
+{
+	return expr_eval(ctx, x, y);
+}
+
+/*
+ * Batched integrand: every operation runs over a whole chunk of
+ * abscissae, so the interpreter's dispatch is paid once per chunk.
+ */
+static void expr_vec(int n, const double x[], double y[], void *data)
+{
+	const struct expr *e = data;
+	double st[EXPR_MAXSTACK][VEC_CHUNK], *a, *b;
+	int i, j, m, sp;
+
+	for (; n > 0; n -= m, x += m, y += m) {
+		m = n < VEC_CHUNK ? n : VEC_CHUNK;
+		sp = 0;
+		for (i = 0; i < e->nops; i++) {
+			switch (e->op[i]) {
+			case OP_NUM:
+				b = st[sp++];
+				for (j = 0; j < m; j++)
+					b[j] = e->num[i];
+				break;
+			case OP_X:
+				memcpy(st[sp++], x, m * sizeof(*x));
+				break;
+			case OP_Y:
+				memset(st[sp++], 0, m * sizeof(*x));
+				break;
+			case OP_ADD:
+				a = st[sp-2], b = st[sp-1], sp--;
+				for (j = 0; j < m; j++)
+					a[j] += b[j];
+				break;
+			case OP_SUB:
+				a = st[sp-2], b = st[sp-1], sp--;
+				for (j = 0; j < m; j++)
+					a[j] -= b[j];
+				break;
+			case OP_MUL:
+				a = st[sp-2], b = st[sp-1], sp--;
+				for (j = 0; j < m; j++)
+					a[j] *= b[j];
+				break;
+			case OP_DIV:
+				a = st[sp-2], b = st[sp-1], sp--;
+				for (j = 0; j < m; j++)
+					a[j] /= b[j];
+				break;
+			case OP_POW:
+				a = st[sp-2], b = st[sp-1], sp--;
+				for (j = 0; j < m; j++)
+					a[j] = pow(a[j], b[j]);
+				break;
+			case OP_NEG:
+				a = st[sp-1];
+				for (j = 0; j < m; j++)
+					a[j] = -a[j];
+				break;
+			case OP_ABS:
+				a = st[sp-1];
+				for (j = 0; j < m; j++)
+					a[j] = fabs(a[j]);
+				break;
+			case OP_SQRT:
+				a = st[sp-1];
+				for (j = 0; j < m; j++)
+					a[j] = sqrt(a[j]);
+				break;
+			case OP_EXP:
+				a = st[sp-1];
+				vexp(m, a, a);
+				break;
+			case OP_LOG:
+				a = st[sp-1];
+				for (j = 0; j < m; j++)
+					a[j] = log(a[j]);
+				break;
+			case OP_SIN:
+				a = st[sp-1];
+				vsin(m, a, a);
+				break;
+			case OP_COS:
+				a = st[sp-1];
+				vcos(m, a, a);
+				break;
+			case OP_TAN:
+				a = st[sp-1];
+				for (j = 0; j < m; j++)
+					a[j] = tan(a[j]);
+				break;
+			}
+		}
+		memcpy(y, st[0], m * sizeof(*y));
+	}
+}
+
+/* grows *@pbuf to hold @n doubles */
+static int reserve(double **pbuf, size_t *pcap, size_t n)
+{
+	double *buf;
+
+	if (n <= *pcap)
+		return 0;
+	buf = realloc(*pbuf, n * sizeof(*buf));
+	if (buf == NULL)
+		return -1;
+	*pbuf = buf;
+	*pcap = n;
+	return 0;
+}
+
+/* parses one line into @p, returns nonzero for a blank or comment line */
+static int parse_problem(const char *line, size_t len, struct problem *p,
+			 long lineno)
+{
+	struct cursor c = {line, line + len};
+	char tok[64];
+	double v;
+	int i, nargs, wlen;
+
+	wlen = next_word(&c, tok, sizeof(tok));
+	if (wlen == 0 || tok[0] == '#')
+		return 1;
+	p->status = BATCH_OK;
+	p->nres = 0;
+	p->iters = 0;
+	p->done = 0;
+	if (wlen < 0) {
+		fprintf(stderr, "line %ld: unknown problem '%s...'\n",
+			lineno, tok);
+		p->kind = PROBLEM_INVALID;
+		p->status = BATCH_EPARSE;
+		return 0;
+	}
+
+	if (strcmp(tok, "linear") == 0) {
+		p->kind = PROBLEM_LINEAR;
+		if (next_number(&c, &v) || v != floor(v)
+		    || v < 1 || v > BATCH_MAXN)
+			goto bad;
+		p->n = v;
+		if (reserve(&p->mat, &p->matcap, (size_t) p->n * (p->n + 1))
+		    || reserve(&p->res, &p->rescap, p->n)) {
+			p->status = BATCH_ENOMEM;
+			return 0;
+		}
+		for (i = 0; i < p->n * p->n; i++) {
+			if (next_number(&c, &p->mat[i / p->n * (p->n + 1)
+						    + i % p->n]))
+				goto bad;
+		}
+		for (i = 0; i < p->n; i++) {
+			if (next_number(&c, &p->mat[i * (p->n + 1) + p->n]))
+				goto bad;
+		}
+		if (next_word(&c, tok, sizeof(tok)) != 0)
+			goto bad;
+		return 0;
+	}
+
+	if (strcmp(tok, "root") == 0) {
+		p->kind = PROBLEM_ROOT;
+		nargs = 3;
+	} else if (strcmp(tok, "integrate") == 0) {
+		p->kind = PROBLEM_INTEGRATE;
+		nargs = 3;
+	} else if (strcmp(tok, "ivp") == 0) {
+		p->kind = PROBLEM_IVP;
+		nargs = 4;
+	} else {
+		fprintf(stderr, "line %ld: unknown problem '%s'\n",
+			lineno, tok);
+		p->kind = PROBLEM_INVALID;
+		p->status = BATCH_EPARSE;
+		return 0;
+	}
+	for (i = 0; i < nargs; i++) {
+		if (next_number(&c, &p->arg[i]) || !isfinite(p->arg[i]))
+			goto bad;
+	}
+	/* the solver takes (b - a) / h steps as an int */
+	if (p->kind == PROBLEM_IVP
+	    && !(p->arg[2] > 0 && p->arg[1] >= p->arg[0]
+		 && (p->arg[1] - p->arg[0]) / p->arg[2] <= BATCH_MAXSTEPS))
+		goto bad;
+	if (reserve(&p->res, &p->rescap, 2)) {
+		p->status = BATCH_ENOMEM;
+		return 0;
+	}
+	if (parse_expr(&c, &p->expr))
+		goto bad;
+	return 0;
+
+bad:
+	fprintf(stderr, "line %ld: malformed %s problem\n", lineno,
+		problem_names[p->kind]);
+	p->status = BATCH_EPARSE;
+	return 0;
+}
+
+/* @ws is the solving thread's, sized for BATCH_GK_LIMIT subintervals */
+static void solve_problem(struct problem *p, struct workspace *ws)
+{
+	int i, n = p->n;
+	double err, *a = p->arg;
+
+	if (p->status != BATCH_OK)
+		return;
+
+	switch (p->kind) {
+	case PROBLEM_LINEAR:
+		if (n == 1)
+			p->res[0] = p->mat[1] / p->mat[0];
+		else
+			lsolve_colmaj(p->mat, p->res, n);
+		p->nres = n;
+		break;
+	case PROBLEM_ROOT:
+		p->res[0] = nsolve_secant_ctx(expr_fx, &p->expr, a[0], a[1],
+					      a[2], &p->iters);
+		p->nres = 1;
+		break;
+	case PROBLEM_INTEGRATE:
+		p->res[0] = nintegrate_gk_vec_ws(expr_vec, &p->expr, a[0],
+						 a[1], GK21, a[2], 0,
+						 BATCH_GK_LIMIT, 1, &err,
+						 &p->iters, ws);
+		p->res[1] = err;
+		p->nres = 2;
+		if (err > a[2])
+			p->status = BATCH_ESOLVE;
+		break;
+	case PROBLEM_IVP:
+		p->res[0] = ndsolve_runge_ctx(expr_fxy, &p->expr, a[0], a[1],
+					      a[2], a[3]);
+		p->iters = (a[1] - a[0]) / a[2];
+		p->nres = 1;
+		break;
+	case PROBLEM_INVALID:
+		break;
+	}
+	for (i = 0; i < p->nres; i++) {
+		if (!isfinite(p->res[i]))
+			p->status = BATCH_ESOLVE;
+	}
+}
+
+static int write_problem(FILE *out, const struct problem *p)
+{
+	struct batch_record rec;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.seq = p->seq;
+	rec.kind = p->kind;
+	rec.status = p->status;
+	rec.iters = p->iters;
+	rec.n = p->nres;
+	if (fwrite(&rec, sizeof(rec), 1, out) != 1)
+		return -1;
+	if (p->nres > 0 && fwrite(p->res, sizeof(*p->res), p->nres, out)
+	    != p->nres)
+		return -1;
+	return 0;
+}
+
+static void *solve_thread(void *arg)
+{
+	struct batch *b = arg;
+	struct problem *p;
+	struct workspace ws;
+	int nomem;
+
+	nomem = workspace_init(&ws, nintegrate_gk_workspace(BATCH_GK_LIMIT,
+							    1));
+	pthread_mutex_lock(&b->lock);
+	for (;;) {
+		while (b->nsolved == b->nread && !b->eof)
+			pthread_cond_wait(&b->ready, &b->lock);
+		if (b->nsolved == b->nread)
+			break;
+		p = &b->slot[b->nsolved++ % BATCH_DEPTH];
+		pthread_mutex_unlock(&b->lock);
+
+		if (nomem && p->kind == PROBLEM_INTEGRATE
+		    && p->status == BATCH_OK)
+			p->status = BATCH_ENOMEM;
+		solve_problem(p, &ws);
+
+		pthread_mutex_lock(&b->lock);
+		p->done = 1;
+		pthread_cond_signal(&b->done);
+	}
+	pthread_mutex_unlock(&b->lock);
+	workspace_destroy(&ws);
+	return NULL;
+}
+
+static void *write_thread(void *arg)
+{
+	struct batch *b = arg;
+	struct problem *p;
+
+	pthread_mutex_lock(&b->lock);
+	for (;;) {
+		p = &b->slot[b->nwritten % BATCH_DEPTH];
+		while (!(b->nwritten < b->nread && p->done)
+		       && !(b->nwritten == b->nread && b->eof))
+			pthread_cond_wait(&b->done, &b->lock);
+		if (b->nwritten == b->nread)
+			break;
+		pthread_mutex_unlock(&b->lock);
+
+		if (!b->werr && write_problem(b->out, p))
+			b->werr = errno ? errno : EIO;
+
+		pthread_mutex_lock(&b->lock);
+		p->done = 0;
+		b->nwritten++;
+		pthread_cond_signal(&b->free);
+	}
+	pthread_mutex_unlock(&b->lock);
+	return NULL;
+}
+
+/*
+ * Hands one line to the pipeline, or solves and writes it right away
+ * when no threads could be started.
+ */
+static void submit_line(struct batch *b, const char *line, size_t len,
+			long lineno, int threaded, struct workspace *ws)
+{
+	struct problem *p;
+
+	pthread_mutex_lock(&b->lock);
+	while (b->nread - b->nwritten == BATCH_DEPTH)
+		pthread_cond_wait(&b->free, &b->lock);
+	p = &b->slot[b->nread % BATCH_DEPTH];
+	pthread_mutex_unlock(&b->lock);
+
+	/* the slot is ours until nread moves past it */
+	if (parse_problem(line, len, p, lineno))
+		return;
+	p->seq = b->nread;
+
+	if (!threaded) {
+		solve_problem(p, ws);
+		if (!b->werr && write_problem(b->out, p))
+			b->werr = errno ? errno : EIO;
+		b->nread++;
+		b->nsolved++;
+		b->nwritten++;
+		return;
+	}
+	pthread_mutex_lock(&b->lock);
+	b->nread++;
+	pthread_cond_signal(&b->ready);
+	pthread_mutex_unlock(&b->lock);
+}
+
+/* feeds every line of @in, memory-mapped when it is a regular file */
+static int read_input(struct batch *b, FILE *in, int threaded,
+		      struct workspace *ws)
+{
+	struct stat st;
+	char *map, *line = NULL, *p, *nl, *end;
+	size_t cap = 0;
+	ssize_t len;
+	long lineno = 0;
+
+	if (fstat(fileno(in), &st) == 0 && S_ISREG(st.st_mode)
+	    && st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+			   fileno(in), 0);
+		if (map != MAP_FAILED) {
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+			end = map + st.st_size;
+			for (p = map; p < end; p = nl + 1) {
+				nl = memchr(p, '\n', end - p);
+				if (nl == NULL)
+					nl = end;
+				submit_line(b, p, nl - p, ++lineno,
+					    threaded, ws);
+			}
+			munmap(map, st.st_size);
+			return 0;
+		}
+	}
+
+	while ((len = getline(&line, &cap, in)) > 0) {
+		if (line[len-1] == '\n')
+			len--;
+		submit_line(b, line, len, ++lineno, threaded, ws);
+	}
+	free(line);
+	return ferror(in) ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static struct batch b;
+	const char *output = NULL;
+	FILE *in = stdin;
+	pthread_t writer, *solvers;
+	struct workspace ws;
+	long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	int i, opt, nstarted = 0, threaded, rerr;
+
+	while ((opt = getopt(argc, argv, "j:o:")) != -1) {
+		switch (opt) {
+		case 'j':
+			nthreads = atol(optarg);
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			goto usage;
+		}
+	}
+	if (argc - optind > 1)
+		goto usage;
+	if (nthreads < 1)
+		nthreads = 1;
+
+	if (optind < argc) {
+		in = fopen(argv[optind], "r");
+		if (in == NULL) {
+			perror(argv[optind]);
+			return 1;
+		}
+	}
+	b.out = stdout;
+	if (output != NULL) {
+		b.out = fopen(output, "wb");
+		if (b.out == NULL) {
+			perror(output);
+			return 1;
+		}
+	}
+	setvbuf(b.out, NULL, _IOFBF, 1 << 16);
+	if (fwrite(BATCH_MAGIC, sizeof(BATCH_MAGIC), 1, b.out) != 1)
+		b.werr = errno ? errno : EIO;
+
+	pthread_mutex_init(&b.lock, NULL);
+	pthread_cond_init(&b.ready, NULL);
+	pthread_cond_init(&b.done, NULL);
+	pthread_cond_init(&b.free, NULL);
+	if (workspace_init(&ws, nintegrate_gk_workspace(BATCH_GK_LIMIT, 1))) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	/* without a writer and a solver, the main thread does it all */
+	solvers = malloc(nthreads * sizeof(*solvers));
+	threaded = solvers != NULL
+		   && pthread_create(&writer, NULL, write_thread, &b) == 0;
+	for (i = 0; threaded && i < nthreads; i++) {
+		if (pthread_create(&solvers[nstarted], NULL, solve_thread,
+				   &b) == 0)
+			nstarted++;
+	}
+	if (threaded && nstarted == 0) {
+		pthread_mutex_lock(&b.lock);
+		b.eof = 1;
+		pthread_cond_signal(&b.done);
+		pthread_mutex_unlock(&b.lock);
+		pthread_join(writer, NULL);
+		b.eof = 0;
+		threaded = 0;
+	}
+
+	rerr = read_input(&b, in, threaded, &ws);
+
+	if (threaded) {
+		pthread_mutex_lock(&b.lock);
+		b.eof = 1;
+		pthread_cond_broadcast(&b.ready);
+		pthread_cond_signal(&b.done);
+		pthread_mutex_unlock(&b.lock);
+		for (i = 0; i < nstarted; i++)
+			pthread_join(solvers[i], NULL);
+		pthread_join(writer, NULL);
+	}
+	free(solvers);
+	workspace_destroy(&ws);
+	for (i = 0; i < BATCH_DEPTH; i++) {
+		free(b.slot[i].mat);
+		free(b.slot[i].res);
+	}
+
+	if (rerr)
+		perror("read");
+	if (fflush(b.out) && !b.werr)
+		b.werr = errno ? errno : EIO;
+	if (b.werr)
+		fprintf(stderr, "write: %s\n", strerror(b.werr));
+	if (in != stdin)
+		fclose(in);
+	if (b.out != stdout)
+		fclose(b.out);
+	return rerr || b.werr ? 1 : 0;
+
+usage:
+	fprintf(stderr, "Usage: %s [-j threads] [-o output] [input]\n",
+		argv[0]);
+	return 1;
+}
@@ -0,0 +1,31 @@
+/* Solves linear equations with Gauss-Seidel iteration
+ * Lab Assignment 06, PB09203226
+ */
+
+#include <stdio.h>
+#include "iterative.h"
+
+#define EPSILON	1e-13
+int main(void)
+{
+	double A[][9] = {{31, -13, 0, 0, 0, -10, 0, 0, 0},
+			  {-13, 35, -9, 0, -11, 0, 0, 0, 0},
+			  {0, -9, 31, -10, 0, 0, 0, 0, 0},
+			  {0, 0, -10, 79, -30, 0, 0, 0, -9},
+			  {0, 0, 0, -30, 57, -7, 0, -5, 0},
+			  {0, 0, 0, 0, -7, 47, -30, 0, 0},
+			  {0, 0, 0, 0, 0, -30, 41, 0, 0},
+			  {0, 0, 0, 0, -5, 0, 0, 27, -2},
+			  {0, 0, 0, -9, 0, 0, 0, -2, 29}};
+	double Y[9] = {-15, 27, -23, 0, -20, 12, -7, 7, 10};
+	double X[9] = {1,1,1,1,1,1,1,1,1};
+	int i, nstep;
+
+	lsolve_gauss((double *) A, Y, X, sizeof(X)/sizeof(*X), EPSILON, &nstep);
+	printf("Roots = \n");
+	for (i = 0; i < sizeof(X)/sizeof(*X); i++)
+		printf("%.13f\n", X[i]);
+	printf("Steps = %d\n", nstep);
+
+	return 0;
+}
@@ -0,0 +1,69 @@
+/* Adaptive Gauss-Kronrod integration of smooth, peaked and singular
+ * integrands
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "gauss_kronrod.h"
+
+double f_peak(double x)
+{
+	return 1.0 / ((x - 0.3) * (x - 0.3) + 1e-4);
+}
+
+double f_sqrt(double x)
+{
+	return 1.0 / sqrt(x);
+}
+
+/* inner integral of 1 / (x + y) over y in [1, 5] */
+double f_inner(double x)
+{
+	return log((x + 5.0) / (x + 1.0));
+}
+
+void sin_vec(int n, const double x[], double y[], void *data)
+{
+	vsin(n, x, y);
+}
+
+#define EPSILON	1e-10
+#define LIMIT	1000
+#define test_gk(fn, a, b, rule, nthreads, true_value)	do {		\
+		int __neval;						\
+		double __err;						\
+		double __res = nintegrate_gk(fn, a, b, rule, EPSILON,	\
+					     EPSILON, LIMIT, nthreads,	\
+					     &__err, &__neval);		\
+		printf(#fn ", " #rule ", threads = %d, result = %.13f, "	\
+		       "estimate = %.3e, error = %.3e, evaluations = %d\n", \
+		       nthreads, __res, __err,				\
+		       fabs(__res - (true_value)), __neval);		\
+	} while (0)
+
+int main(void)
+{
+	double peak = 100.0 * (atan(70.0) + atan(30.0));
+
+	test_gk(sin, 1.0, 5.0, GK15, 1, cos(1.0) - cos(5.0));
+	test_gk(sin, 1.0, 5.0, GK21, 1, cos(1.0) - cos(5.0));
+	test_gk(f_peak, 0.0, 1.0, GK15, 1, peak);
+	test_gk(f_peak, 0.0, 1.0, GK21, 1, peak);
+	test_gk(f_peak, 0.0, 1.0, GK21, 4, peak);
+	test_gk(f_sqrt, 0.0, 1.0, GK15, 1, 2.0);
+	test_gk(f_sqrt, 0.0, 1.0, GK21, 4, 2.0);
+	test_gk(f_inner, 1.0, 5.0, GK21, 1, 2.911031660324);
+
+	{
+		int neval;
+		double err;
+		double res = nintegrate_gk_vec(sin_vec, NULL, 1.0, 5.0, GK21,
+					       EPSILON, EPSILON, LIMIT, 1,
+					       &err, &neval);
+		printf("sin_vec, GK21, threads = 1, result = %.13f, "
+		       "estimate = %.3e, error = %.3e, evaluations = %d\n",
+		       res, err, fabs(res - (cos(1.0) - cos(5.0))), neval);
+	}
+
+	return 0;
+}
@@ -0,0 +1,59 @@
+/* Gauss-Legendre integration in 1D, 2D and 3D
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "gauss_legendre.h"
+
+double f(double x, double y)
+{
+	return 1.0 / (x + y);
+}
+
+double g(double x, double y, double z)
+{
+	return exp(-(x * x + y * y + z * z));
+}
+
+int main(void)
+{
+	int i, order;
+	double true_value, nres, e;
+
+	printf("Gauss-Legendre integration:\n");
+	true_value = cos(1.0) - cos(5.0);
+	for (order = 2; order <= 16; order += 2) {
+		nres = nintegrate_gl(sin, 1.0, 5.0, 1, order);
+		printf("order = %d, result = %.13f, error = %.3e\n",
+		       order, nres, fabs(nres - true_value));
+	}
+
+	printf("\n2D Gauss-Legendre integration:\n");
+	true_value = 10.0 * log(10.0) - 12.0 * log(6.0) + 2.0 * log(2.0);
+	for (order = 4; order <= 24; order += 4) {
+		nres = nintegrate_gl_2d(f, 1, 5, 1, 1, 5, 1, order);
+		printf("order = %d, points = %d, result = %.13f, "
+		       "error = %.3e\n", order, order * order, nres,
+		       fabs(nres - true_value));
+	}
+	for (i = 1; i <= 4; i *= 2) {
+		nres = nintegrate_gl_2d(f, 1, 5, i, 1, 5, i, 8);
+		printf("order = 8, subdivisions = %d, result = %.13f, "
+		       "error = %.3e\n", i, nres, fabs(nres - true_value));
+	}
+
+	printf("\n3D Gauss-Legendre integration:\n");
+	e = sqrt(M_PI) / 2.0 * erf(1.0);
+	true_value = e * e * e;
+	for (order = 2; order <= 12; order += 2) {
+		nres = nintegrate_gl_3d(g, 0, 1, 1, 0, 1, 1, 0, 1, 1, order);
+		printf("order = %d, points = %d, result = %.13f, "
+		       "error = %.3e\n", order, order * order * order,
+		       nres, fabs(nres - true_value));
+	}
+	nres = nintegrate_gl_3d(g, 0, 1, 1, 0, 1, 1, 0, 1, 1, 40);
+	printf("order = 40, points = %d, result = %.13f, error = %.3e\n",
+	       40 * 40 * 40, nres, fabs(nres - true_value));
+
+	return 0;
+}
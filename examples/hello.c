@@ -0,0 +1,29 @@
+/* Numerical Methods, Lab Exercise 01
+ * PB09203226 */
+
+#include <stdio.h>
+#include <math.h>
+#include "psi.h"
+
+int main(void)
+{
+	float x;
+	double vx[41], vres[41], max_diff = 0.0;
+	int i, n = 0;
+
+	for (x = 0.0; x < 1.01; x += 0.1) { /* x <= 1.0 won't work (fp issue) */
+		printf("%.2f\t%.13Lf\n", x, get_psi(x));
+		vx[n++] = x;
+	}
+	for (x = 10.0; x <= 300.0; x += 10.0) {
+		printf("%.2f\t%.13Lf\n", x, get_psi(x));
+		vx[n++] = x;
+	}
+
+	get_psi_batch(n, vx, vres, 4);
+	for (i = 0; i < n; i++)
+		max_diff = fmax(max_diff, fabs(vres[i] - get_psi(vx[i])));
+	printf("Batch of %d, max difference = %.3e\n", n, max_diff);
+
+	return 0;
+}
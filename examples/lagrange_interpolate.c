@@ -0,0 +1,43 @@
+/*
+ * Lab Exercise 02, Sept. 10
+ * Implements Lagrange Interpolate
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "lagrange_interpolate.h"
+
+long double fgen_1(int i, int n)
+{
+	return -5.0 + 10.0 * i / n;
+}
+
+#define PI	(atan(1.0) * 4.0)
+long double fgen_2(int i, int n)
+{
+	return -5.0 * cos(PI * (2*i+1) / (2*n+2));
+}
+
+long double fcn(long double x)
+{
+	return 1.0 / (1.0 + x * x);
+}
+
+long double fgen_y(int i)
+{
+	return -5.0 + 0.1 * i;
+}
+
+int main(void)
+{
+	int i;
+
+	for (i = 5; i <= 40; i *= 2) {
+		printf("N = %d\nMax Error of grid (1): %.13Lf\n"
+		       "Max Error of grid (2): %.13Lf\n", i,
+		       get_max_error(i, fgen_1, fcn, 100, fgen_y),
+		       get_max_error(i, fgen_2, fcn, 100, fgen_y));
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+/* Implements column-major Gauss elimination for solving systems
+ * of linear equations
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "lineq_solver.h"
+
+int main(void)
+{
+	double A[][10] = {{31, -13, 0, 0, 0, -10, 0, 0, 0, -15},
+			   {-13, 35, -9, 0, -11, 0, 0, 0, 0, 27},
+			   {0, -9, 31, -10, 0, 0, 0, 0, 0, -23},
+			   {0, 0, -10, 79, -30, 0, 0, 0, -9, 0},
+			   {0, 0, 0, -30, 57, -7, 0, -5, 0, -20},
+			   {0, 0, 0, 0, -7, 47, -30, 0, 0, 12},
+			   {0, 0, 0, 0, 0, -30, 41, 0, 0, -7},
+			   {0, 0, 0, 0, -5, 0, 0, 27, -2, 7},
+			   {0, 0, 0, -9, 0, 0, 0, -2, 29, 10}};
+	double X[9];
+	lsolve_colmaj((double *)A, X, 9);
+
+	printf("Roots = \n");
+	int i;
+	for (i = 0; i < 9; i++)
+		printf("%.13f\n", X[i]);
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+/* Monte Carlo and quasi-Monte Carlo integration in 6 to 20 dimensions
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "monte_carlo.h"
+
+/* Sobol's g-function, integral 1 over the unit cube */
+void g_vec(int n, int dim, const double x[], double y[], void *data)
+{
+	double p;
+	int i, j;
+
+	for (i = 0; i < n; i++) {
+		p = 1.0;
+		for (j = 0; j < dim; j++)
+			p *= (fabs(4.0 * x[i*dim + j] - 2.0) + j + 1)
+			     / (j + 2);
+		y[i] = p;
+	}
+}
+
+/* Gaussian, integral (sqrt(pi) / 2 * erf(1))^dim over the unit cube */
+void gauss_vec(int n, int dim, const double x[], double y[], void *data)
+{
+	double s;
+	int i, j;
+
+	for (i = 0; i < n; i++) {
+		s = 0.0;
+		for (j = 0; j < dim; j++)
+			s += x[i*dim + j] * x[i*dim + j];
+		y[i] = -s;
+	}
+	vexp(n, y, y);
+}
+
+static const char *mc_names[] = {
+	[MC_PSEUDO] = "pseudo",
+	[MC_HALTON] = "Halton",
+	[MC_SOBOL] = "Sobol",
+};
+
+#define NREP	16
+#define test_mc(fv, dim, method, true_value)	do {			\
+		double __a[MC_MAXDIM] = {0}, __b[MC_MAXDIM];		\
+		double __err, __res;					\
+		long __n;						\
+		int __i;						\
+		for (__i = 0; __i < (dim); __i++)			\
+			__b[__i] = 1.0;					\
+		for (__n = 1 << 10; __n <= 1 << 16; __n *= 4) {	\
+			__res = nintegrate_mc_vec(fv, NULL, dim, __a, __b, \
+						  __n, NREP, method, 42, 4, \
+						  &__err);		\
+			printf("%s, dim = %d, N = %ld, result = %.10f, " \
+			       "stderr = %.3e, error = %.3e\n",		\
+			       mc_names[method], dim, __n, __res, __err, \
+			       fabs(__res - (true_value)));		\
+		}							\
+	} while (0)
+
+int main(void)
+{
+	double e = pow(sqrt(M_PI) / 2.0 * erf(1.0), 6);
+
+	test_mc(g_vec, 8, MC_PSEUDO, 1.0);
+	test_mc(g_vec, 8, MC_HALTON, 1.0);
+	test_mc(g_vec, 8, MC_SOBOL, 1.0);
+	test_mc(g_vec, 20, MC_SOBOL, 1.0);
+	test_mc(gauss_vec, 6, MC_PSEUDO, e);
+	test_mc(gauss_vec, 6, MC_SOBOL, e);
+
+	return 0;
+}
@@ -0,0 +1,30 @@
+/* Implements numerical composite trapezoidal and Simpson integration
+ * Lab experiment 03, PB09203226
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "numerical_integration.h"
+
+int main(void)
+{
+	int i;
+	double true_value = cos(1.0) - cos(5.0);
+	double nres;
+
+	printf("Composite trapezoidal integration:\n");
+	for (i = 1; i <= 1 << 12; i *= 2) {
+		nres = nintegrate_trapezodial(sin, 1.0, 5.0, i);
+		printf("n = %d, result = %.13f, error = %.13f\n",
+		       i, nres, fabs(nres - true_value));
+	}
+
+	printf("\nComposite Simpson integration:\n");
+	for (i = 2; i <= 1 << 12; i *= 2) {
+		nres = nintegrate_simpson(sin, 1.0, 5.0, i);
+		printf("n = %d, result = %.13f, error = %.13f\n",
+		       i, nres, fabs(nres - true_value));
+	}
+
+	return 0;
+}
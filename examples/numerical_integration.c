@@ -0,0 +1,76 @@
+/* Implements numerical composite trapezoidal and Simpson integration
+ * in both 1D and 2D
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+#include "numerical_integration.h"
+
+double f(double x, double y)
+{
+	return 1.0 / (x + y);
+}
+
+void sin_vec(int n, const double x[], double y[], void *data)
+{
+	vsin(n, x, y);
+}
+
+void f_vec(int n, const double x[], const double y[], double z[],
+	   void *data)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		z[i] = 1.0 / (x[i] + y[i]);
+}
+
+int main(void)
+{
+	int i;
+	double true_value;
+	double nres;
+
+	true_value = cos(1.0) - cos(5.0);
+	printf("Composite trapezoidal integration:\n");
+	for (i = 1; i <= 1 << 12; i *= 2) {
+		nres = nintegrate_trapezodial(sin, 1.0, 5.0, i);
+		printf("n = %d, result = %.13f, error = %.13f\n",
+		       i, nres, fabs(nres - true_value));
+	}
+
+	printf("\nComposite Simpson integration:\n");
+	for (i = 2; i <= 1 << 12; i *= 2) {
+		nres = nintegrate_simpson(sin, 1.0, 5.0, i);
+		printf("n = %d, result = %.13f, error = %.13f\n",
+		       i, nres, fabs(nres - true_value));
+	}
+
+	printf("\n2D Composite trapezodial integration:\n");
+	true_value = 2.911031660324;
+	for (i = 1; i <= 1 << 12; i *= 2) {
+		nres = nintegrate_trapezodial_2d(f, 1, 5, i, 1, 5, i);
+		printf("n = %d, result = %.13f, error = %.13f\n",
+		       i, nres, fabs(nres - true_value));
+	}
+
+	printf("\n2D Composite Simpson integration:\n");
+	for (i = 1; i <= 1 << 12; i *= 2) {
+		nres = nintegrate_simpson_2d(f, 1, 5, i, 1, 5, i);
+		printf("n = %d, result = %.13f, error = %.13f\n",
+		       i, nres, fabs(nres - true_value));
+	}
+
+	printf("\nBatched integrands:\n");
+	nres = nintegrate_simpson_vec(sin_vec, NULL, 1.0, 5.0, 1 << 12);
+	printf("1D Simpson, n = %d, result = %.13f, error = %.13f\n",
+	       1 << 12, nres, fabs(nres - (cos(1.0) - cos(5.0))));
+	nres = nintegrate_2d_vec(f_vec, NULL, 1, 5, 1 << 12, 1, 5, 1 << 12,
+				 NINTEGRATE_SIMPSON,
+				 sysconf(_SC_NPROCESSORS_ONLN));
+	printf("2D Simpson, n = %d, result = %.13f, error = %.13f\n",
+	       1 << 12, nres, fabs(nres - true_value));
+
+	return 0;
+}
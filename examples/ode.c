@@ -0,0 +1,41 @@
+/* Lab Assignment 07
+ * PB09203226
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "ode.h"
+
+double f(double x, double y)
+{
+	return - x * x * y * y;
+}
+
+double y(double x)
+{
+	return 3.0 / (1.0 + x * x * x);
+}
+
+#define test_ndsolve(h, method)		do {				\
+		double __res = ndsolve_##method(&f, 0, 1.5, (h), 3);	\
+		printf("Step = %f, Result = %.13f, Error = %.13f\n",	\
+		       (h), __res, fabs(__res - y(1.5)));		\
+	} while (0)
+#define test_runge(h)	test_ndsolve((h), runge)
+#define test_adams(h)	test_ndsolve((h), adams)
+
+int main(void)
+{
+	puts("Runge-Kutta Method:");
+	test_runge(0.1);
+	test_runge(0.05);
+	test_runge(0.025);
+	test_runge(0.0125);
+	puts("\nAdams Method:");
+	test_adams(0.1);
+	test_adams(0.05);
+	test_adams(0.025);
+	test_adams(0.0125);
+
+	return 0;
+}
@@ -0,0 +1,41 @@
+/* Romberg integration against the repeated composite rules
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "romberg.h"
+
+void sin_vec(int n, const double x[], double y[], void *data)
+{
+	vsin(n, x, y);
+}
+
+int main(void)
+{
+	int neval, total;
+	double true_value = cos(1.0) - cos(5.0);
+	double epsilon, nres, err;
+
+	printf("Romberg integration:\n");
+	for (epsilon = 1e-2; epsilon >= 1e-13; epsilon /= 10.0) {
+		nres = nintegrate_romberg(sin, 1.0, 5.0, epsilon,
+					  ROMBERG_MAXLEVEL, &err, &neval);
+		printf("epsilon = %.0e, result = %.13f, estimate = %.3e, "
+		       "error = %.13f, evaluations = %d\n", epsilon, nres,
+		       err, fabs(nres - true_value), neval);
+	}
+
+	nres = nintegrate_romberg_vec(sin_vec, NULL, 1.0, 5.0, 1e-13,
+				      ROMBERG_MAXLEVEL, &err, &neval);
+	printf("\nBatched integrand: result = %.13f, estimate = %.3e, "
+	       "error = %.13f, evaluations = %d\n", nres, err,
+	       fabs(nres - true_value), neval);
+
+	/* what the doubling loops in nintegrate.c pay for n = 1..4096 */
+	for (total = 0, neval = 1; neval <= 1 << 12; neval *= 2)
+		total += neval + 1;
+	printf("\nRepeated composite rules up to n = 4096: "
+	       "%d evaluations\n", total);
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+/* Keeps an ODE trajectory and a 2D sample grid in memory-mapped files
+ * and reads them back in place
+ *
+ * Usage: sink [directory]
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "numerical.h"
+
+double f(double x, double y)
+{
+	return - x * x * y * y;
+}
+
+double g(double x, double y)
+{
+	return exp(- x * x - y * y);
+}
+
+/* largest deviation of the stored trajectory from the exact solution */
+static void check_trajectory(const char *path, double res)
+{
+	struct sink_view v;
+	uint64_t i, n;
+	double x, err = 0.0;
+
+	if (sink_view_open(&v, path)) {
+		perror(path);
+		return;
+	}
+	n = sink_view_records(&v);
+	for (i = 0; i < n; i++) {
+		x = v.hdr->origin[0] + i * v.hdr->step[0];
+		err = fmax(err, fabs(v.data[i] - 3.0 / (1.0 + x * x * x)));
+	}
+	printf("%s: %llu of %llu records, last = %.13f (returned %.13f), "
+	       "max error = %.3e\n", path, (unsigned long long) n,
+	       (unsigned long long) v.hdr->nrows, v.data[n-1], res, err);
+	sink_view_close(&v);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *dir = argc > 1 ? argv[1] : "/tmp";
+	char ode_path[4096], grid_path[4096];
+	struct sink s;
+	struct sink_view v;
+	double res, sum = 0.0;
+	uint64_t i, nvalues;
+
+	snprintf(ode_path, sizeof(ode_path), "%s/ode.sink", dir);
+	snprintf(grid_path, sizeof(grid_path), "%s/grid.sink", dir);
+
+	if (sink_open(&s, ode_path)) {
+		perror(ode_path);
+		return 1;
+	}
+	res = ndsolve_runge_sink(f, 0, 1.5, 0.0125, 3, &s);
+	check_trajectory(ode_path, res);
+	res = ndsolve_adams_sink(f, 0, 1.5, 0.0125, 3, &s);
+	if (sink_close(&s))
+		perror(ode_path);
+	check_trajectory(ode_path, res);
+
+	if (sink_open(&s, grid_path)) {
+		perror(grid_path);
+		return 1;
+	}
+	if (generate_sample_2d_sink(g, -4, 0.01, 800, -4, 0.01, 800, &s)
+	    || sink_close(&s))
+		perror(grid_path);
+	if (sink_view_open(&v, grid_path)) {
+		perror(grid_path);
+		return 1;
+	}
+	nvalues = sink_view_records(&v) * v.hdr->ncols;
+	for (i = 0; i < nvalues; i++)
+		sum += v.data[i];
+	printf("%s: %llu x %llu samples, sum * h * k = %.13f (pi = %.13f)\n",
+	       grid_path, (unsigned long long) sink_view_records(&v),
+	       (unsigned long long) v.hdr->ncols,
+	       sum * v.hdr->step[0] * v.hdr->step[1], M_PI);
+	sink_view_close(&v);
+
+	return 0;
+}
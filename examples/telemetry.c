@@ -0,0 +1,60 @@
+/* Runs a few solvers from two threads and prints the metrics they
+ * recorded, first as JSON, then in the Prometheus text format.
+ * Build with make TELEMETRY=1, otherwise there is nothing to show.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+#include "numerical.h"
+
+static double f(double x)
+{
+	return x * x * x / 3.0 - x;
+}
+
+static double fprime(double x)
+{
+	return x * x - 1.0;
+}
+
+static double g(double x, double y)
+{
+	return - x * x * y * y;
+}
+
+static void *work(void *p)
+{
+	double A[3][3] = {{4, 1, 0}, {1, 4, 1}, {0, 1, 4}};
+	double Y[3] = {1, 2, 3}, X[3];
+	int i, nstep, nr_iter;
+
+	for (i = 0; i < 10; i++) {
+		X[0] = X[1] = X[2] = 0.0;
+		lsolve_sor((double *) A, Y, X, 1.1, 3, 1e-12, &nstep);
+		nsolve_newton(f, fprime, 8.0 + i, 1e-13, &nr_iter);
+		ndsolve_adams(g, 0, 1.5, 0.01, 3);
+		nintegrate_romberg(sin, 1.0, 5.0, 1e-12, ROMBERG_MAXLEVEL,
+				   NULL, NULL);
+		nintegrate_gk(sqrt, 0.0, 4.0, GK21, 1e-10, 1e-10, 1000, 1,
+			      NULL, NULL);
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	struct telemetry_snapshot snap;
+	pthread_t tid;
+
+	pthread_create(&tid, NULL, work, NULL);
+	work(NULL);
+	pthread_join(tid, NULL);
+
+	telemetry_snapshot(&snap);
+	telemetry_write_json(stdout, &snap);
+	printf("\n");
+	telemetry_write_prometheus(stdout, &snap);
+
+	return 0;
+}
@@ -0,0 +1,508 @@
+/* Implements adaptive Gauss-Kronrod integration
+ *
+ * Subintervals live in a pool allocated once per call and are
+ * scheduled through a max-heap keyed by their error estimates; the
+ * worst ones are bisected first, several at a time if worker threads
+ * are available.
+ */
+
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#undef NDEBUG
+#include <assert.h>
+#include "gauss_kronrod.h"
+#include "telemetry.h"
+
+/*
+ * Abscissae of the Kronrod rules on [-1, 1], positive half in
+ * decreasing order, centre last.  Odd entries are the Gauss abscissae.
+ * Values as in QUADPACK qk15 / qk21.
+ */
+static const double xgk15[8] = {
+	0.991455371120812639206854697526329,
+	0.949107912342758524526189684047851,
+	0.864864423359769072789712788640926,
+	0.741531185599394439863864773280788,
+	0.586087235467691130294144845693013,
+	0.405845151377397166906606412076961,
+	0.207784955007898467600689403773245,
+	0.000000000000000000000000000000000,
+};
+static const double wgk15[8] = {
+	0.022935322010529224963732008058970,
+	0.063092092629978553290700663189204,
+	0.104790010322250183839876322541518,
+	0.140653259715525918745189590510238,
+	0.169004726639267902826583426598550,
+	0.190350578064785409913256402421014,
+	0.204432940075298892414161999234649,
+	0.209482141084727828012999174891714,
+};
+static const double wg7[4] = {
+	0.129484966168869693270611432679082,
+	0.279705391489276667901467771423780,
+	0.381830050505118944950369775488975,
+	0.417959183673469387755102040816327,
+};
+
+static const double xgk21[11] = {
+	0.995657163025808080735527280689003,
+	0.973906528517171720077964012084452,
+	0.930157491355708226001207180059508,
+	0.865063366688984510732096688423493,
+	0.780817726586416897063717578345042,
+	0.679409568299024406234327365114874,
+	0.562757134668604683339000099272694,
+	0.433395394129247190799265943165784,
+	0.294392862701460198131126603103866,
+	0.148874338981631210884826001129720,
+	0.000000000000000000000000000000000,
+};
+static const double wgk21[11] = {
+	0.011694638867371874278064396062192,
+	0.032558162307964727478818972459390,
+	0.054755896574351996031381300244580,
+	0.075039674810919952767043140916190,
+	0.093125454583697605535065465083366,
+	0.109387158802297641899210590325805,
+	0.123491976262065851077208980223031,
+	0.134709217311473325928054001771707,
+	0.142775938577060080797094273138717,
+	0.147739104901338491374841515972068,
+	0.149445554002916905664936468389821,
+};
+static const double wg10[5] = {
+	0.066671344308688137593568809893332,
+	0.149451349150580593145776339657697,
+	0.219086362515982043995534934228163,
+	0.269266719309996355091226921569469,
+	0.295524224714752870173892994651338,
+};
+
+static const struct {
+	int nk;			/* entries in xk[] and wk[] */
+	const double *xk, *wk, *wg;
+	int center;		/* Gauss rule has the centre node */
+} gk_rules[] = {
+	[GK15] = {8, xgk15, wgk15, wg7, 1},
+	[GK21] = {11, xgk21, wgk21, wg10, 0},
+};
+
+struct gk_interval {
+	double a, b;
+	double result, err;
+};
+
+/**
+ * gk_apply:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @rule : Gauss-Kronrod pair to use
+ * @iv : interval, result and err are filled in
+ *
+ * Applies one Gauss-Kronrod pair on [iv->a, iv->b], with all nodes
+ * passed to @fv in one call.  The error estimate is the difference of
+ * both rules, scaled as in QUADPACK.
+ *
+ * Modifies iv.	No return value.
+ */
+static void gk_apply(vec_fn fv, void *data, enum gk_rule rule,
+		     struct gk_interval *iv)
+{
+	int nk = gk_rules[rule].nk;
+	const double *xk = gk_rules[rule].xk;
+	const double *wk = gk_rules[rule].wk;
+	const double *wg = gk_rules[rule].wg;
+	double v[2 * nk - 1];
+	double *fv1 = v + 1, *fv2 = v + nk;
+	double center = (iv->a + iv->b) / 2.0;
+	double hlength = (iv->b - iv->a) / 2.0;
+	double fc, resk, resg = 0.0;
+	double resabs, resasc, mean, err;
+	int j;
+
+	v[0] = center;
+	for (j = 0; j < nk - 1; j++) {
+		fv1[j] = center - hlength * xk[j];
+		fv2[j] = center + hlength * xk[j];
+	}
+	fv(2 * nk - 1, v, v, data);
+
+	fc = v[0];
+	resk = wk[nk-1] * fc;
+	resabs = fabs(resk);
+	if (gk_rules[rule].center)
+		resg = wg[nk/2 - 1] * fc;
+	for (j = 0; j < nk - 1; j++) {
+		resk += wk[j] * (fv1[j] + fv2[j]);
+		resabs += wk[j] * (fabs(fv1[j]) + fabs(fv2[j]));
+		if (j % 2 == 1)
+			resg += wg[j/2] * (fv1[j] + fv2[j]);
+	}
+
+	mean = resk / 2.0;
+	resasc = wk[nk-1] * fabs(fc - mean);
+	for (j = 0; j < nk - 1; j++)
+		resasc += wk[j] * (fabs(fv1[j] - mean) + fabs(fv2[j] - mean));
+
+	iv->result = resk * hlength;
+	resabs *= fabs(hlength);
+	resasc *= fabs(hlength);
+	err = fabs((resk - resg) * hlength);
+	if (resasc != 0.0 && err != 0.0)
+		err = resasc * fmin(1.0, pow(200.0 * err / resasc, 1.5));
+	if (resabs > DBL_MIN / (50.0 * DBL_EPSILON))
+		err = fmax(err, 50.0 * DBL_EPSILON * resabs);
+	iv->err = err;
+}
+
+/* max-heap of intervals keyed by err */
+static void heap_push(struct gk_interval **heap, int *pn,
+		      struct gk_interval *iv)
+{
+	int i = (*pn)++, parent;
+
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (heap[parent]->err >= iv->err)
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = iv;
+}
+
+static struct gk_interval *heap_pop(struct gk_interval **heap, int *pn)
+{
+	struct gk_interval *top = heap[0], *last = heap[--*pn];
+	int i = 0, child, n = *pn;
+
+	while ((child = 2 * i + 1) < n) {
+		if (child + 1 < n && heap[child+1]->err > heap[child]->err)
+			child++;
+		if (last->err >= heap[child]->err)
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	if (n > 0)
+		heap[i] = last;
+	return top;
+}
+
+/*
+ * Worker threads stay alive for the whole call.  Every round the
+ * caller publishes a list of intervals and bumps the round counter;
+ * all threads (the caller being thread 0) apply the rule to their
+ * share of the list and the caller waits until the others are done.
+ */
+struct gk_workers {
+	vec_fn fv;
+	void *data;
+	enum gk_rule rule;
+	int nthreads;
+	pthread_mutex_t lock;
+	pthread_cond_t start, done;
+	unsigned round;
+	int pending;
+	int quit;
+	struct gk_interval **jobs;
+	int njobs;
+};
+
+struct gk_worker_arg {
+	struct gk_workers *w;
+	int id;
+};
+
+static void gk_run_share(struct gk_workers *w, int id)
+{
+	int i;
+
+	for (i = id; i < w->njobs; i += w->nthreads)
+		gk_apply(w->fv, w->data, w->rule, w->jobs[i]);
+}
+
+static void *gk_worker(void *p)
+{
+	struct gk_worker_arg *arg = p;
+	struct gk_workers *w = arg->w;
+	unsigned seen = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&w->lock);
+		while (w->round == seen && !w->quit)
+			pthread_cond_wait(&w->start, &w->lock);
+		if (w->quit) {
+			pthread_mutex_unlock(&w->lock);
+			break;
+		}
+		seen = w->round;
+		pthread_mutex_unlock(&w->lock);
+
+		gk_run_share(w, arg->id);
+
+		pthread_mutex_lock(&w->lock);
+		if (--w->pending == 0)
+			pthread_cond_signal(&w->done);
+		pthread_mutex_unlock(&w->lock);
+	}
+	return NULL;
+}
+
+static void gk_run_round(struct gk_workers *w)
+{
+	if (w->nthreads == 1) {
+		gk_run_share(w, 0);
+		return;
+	}
+	pthread_mutex_lock(&w->lock);
+	w->round++;
+	w->pending = w->nthreads - 1;
+	pthread_cond_broadcast(&w->start);
+	pthread_mutex_unlock(&w->lock);
+
+	gk_run_share(w, 0);
+
+	pthread_mutex_lock(&w->lock);
+	while (w->pending > 0)
+		pthread_cond_wait(&w->done, &w->lock);
+	pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * nintegrate_gk_workspace:
+ * @limit : maximal number of subintervals
+ * @nthreads : number of threads evaluating the integrand
+ *
+ * Returns: Bytes of workspace needed by nintegrate_gk_vec_ws()
+ */
+size_t nintegrate_gk_workspace(int limit, int nthreads)
+{
+	return workspace_size(limit, sizeof(struct gk_interval))
+	       + 2 * workspace_size(limit, sizeof(struct gk_interval *))
+	       + workspace_size(nthreads - 1, sizeof(pthread_t))
+	       + workspace_size(nthreads - 1, sizeof(struct gk_worker_arg));
+}
+
+/**
+ * nintegrate_gk_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @rule : GK15 or GK21
+ * @epsabs : requested absolute error
+ * @epsrel : requested relative error
+ * @limit : maximal number of subintervals
+ * @nthreads : number of threads evaluating the integrand
+ * @perr : error estimate of the result, may be NULL
+ * @pneval : number of evaluations of @fv, may be NULL
+ * @ws : workspace for the subintervals and thread handles
+ *
+ * Performs adaptive Gauss-Kronrod integration.  The @limit subintervals
+ * are taken from @ws up front; each round takes the @nthreads subintervals
+ * with the largest error estimates off the heap and bisects them.  The
+ * halves are evaluated in parallel, so @fv must be thread safe when
+ * @nthreads > 1.  Stops when the total error estimate drops below
+ * max(@epsabs, @epsrel * |result|), when @limit is reached or when the
+ * worst subinterval can no longer be bisected.
+ *
+ * The result is summed over the subintervals in pool order, so it does
+ * not depend on thread scheduling.
+ *
+ * Returns: Result of integration, NaN if @ws is too small
+ */
+double nintegrate_gk_vec_ws(vec_fn fv, void *data, double a, double b,
+			    enum gk_rule rule, double epsabs, double epsrel,
+			    int limit, int nthreads, double *perr, int *pneval,
+			    struct workspace *ws)
+{
+	size_t mark = workspace_mark(ws);
+	struct gk_interval *pool = workspace_alloc(ws, limit, sizeof(*pool));
+	struct gk_interval **heap = workspace_alloc(ws, limit, sizeof(*heap));
+	struct gk_interval **jobs = workspace_alloc(ws, limit, sizeof(*jobs));
+	pthread_t *tids = workspace_alloc(ws, nthreads - 1, sizeof(*tids));
+	struct gk_worker_arg *args = workspace_alloc(ws, nthreads - 1,
+						     sizeof(*args));
+	struct gk_workers w;
+	struct gk_interval *iv, *right;
+	int npool = 0, nheap = 0, neval, nrule;
+	int i, nsplit, nstarted = 0;
+	double result, err, mid;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_GK);
+	assert(fv != NULL);
+	assert(rule == GK15 || rule == GK21);
+	assert(limit >= 1 && nthreads >= 1);
+	if (pool == NULL || heap == NULL || jobs == NULL
+	    || tids == NULL || args == NULL) {
+		result = nan("workspace too small");
+		err = INFINITY;
+		neval = 0;
+		goto out;
+	}
+
+	w.fv = fv;
+	w.data = data;
+	w.rule = rule;
+	w.nthreads = nthreads;
+	w.jobs = jobs;
+	w.njobs = 0;
+	w.quit = 0;
+	w.round = 0;
+	w.pending = 0;
+	pthread_mutex_init(&w.lock, NULL);
+	pthread_cond_init(&w.start, NULL);
+	pthread_cond_init(&w.done, NULL);
+	for (i = 0; i < nthreads - 1; i++) {
+		args[i].w = &w;
+		args[i].id = i + 1;
+		if (pthread_create(&tids[i], NULL, gk_worker, &args[i]))
+			break;
+	}
+	nstarted = i;
+	/* run with whatever threads we could get */
+	w.nthreads = nstarted + 1;
+
+	nrule = 2 * gk_rules[rule].nk - 1;
+	iv = &pool[npool++];
+	iv->a = a;
+	iv->b = b;
+	gk_apply(fv, data, rule, iv);
+	neval = nrule;
+	heap_push(heap, &nheap, iv);
+	result = iv->result;
+	err = iv->err;
+
+	while (err > fmax(epsabs, epsrel * fabs(result)) && npool < limit) {
+		/* take the worst intervals, keep the left half in place */
+		w.njobs = 0;
+		nsplit = 0;
+		while (nheap > 0 && nsplit < w.nthreads && npool < limit) {
+			iv = heap[0];
+			mid = (iv->a + iv->b) / 2.0;
+			if (!(mid > iv->a && mid < iv->b))
+				break;
+			heap_pop(heap, &nheap);
+			result -= iv->result;
+			err -= iv->err;
+			right = &pool[npool++];
+			right->a = mid;
+			right->b = iv->b;
+			iv->b = mid;
+			jobs[w.njobs++] = iv;
+			jobs[w.njobs++] = right;
+			nsplit++;
+		}
+		if (nsplit == 0)
+			break;
+
+		gk_run_round(&w);
+		neval += w.njobs * nrule;
+
+		for (i = 0; i < w.njobs; i++) {
+			result += jobs[i]->result;
+			err += jobs[i]->err;
+			heap_push(heap, &nheap, jobs[i]);
+		}
+		telemetry_iter(&tm, err);
+	}
+
+	/* the running sums drift, add up the pool once more */
+	result = err = 0.0;
+	for (i = 0; i < npool; i++) {
+		result += pool[i].result;
+		err += pool[i].err;
+	}
+
+	pthread_mutex_lock(&w.lock);
+	w.quit = 1;
+	pthread_cond_broadcast(&w.start);
+	pthread_mutex_unlock(&w.lock);
+	for (i = 0; i < nstarted; i++)
+		pthread_join(tids[i], NULL);
+	pthread_cond_destroy(&w.done);
+	pthread_cond_destroy(&w.start);
+	pthread_mutex_destroy(&w.lock);
+
+out:
+	if (perr != NULL)
+		*perr = err;
+	if (pneval != NULL)
+		*pneval = neval;
+	telemetry_evals(&tm, neval);
+	telemetry_residual(&tm, err);
+	telemetry_bytes(&tm, ws->used - mark);
+	telemetry_end(&tm);
+	workspace_release(ws, mark);
+
+	return result;
+}
+
+/**
+ * nintegrate_gk_vec:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @rule : GK15 or GK21
+ * @epsabs : requested absolute error
+ * @epsrel : requested relative error
+ * @limit : maximal number of subintervals
+ * @nthreads : number of threads evaluating the integrand
+ * @perr : error estimate of the result, may be NULL
+ * @pneval : number of evaluations of @fv, may be NULL
+ *
+ * Same as nintegrate_gk_vec_ws() with a workspace of its own.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_gk_vec(vec_fn fv, void *data, double a, double b,
+			 enum gk_rule rule, double epsabs, double epsrel,
+			 int limit, int nthreads, double *perr, int *pneval)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_gk_workspace(limit, nthreads))) {
+		if (perr != NULL)
+			*perr = INFINITY;
+		if (pneval != NULL)
+			*pneval = 0;
+		return nan("out of memory");
+	}
+	res = nintegrate_gk_vec_ws(fv, data, a, b, rule, epsabs, epsrel,
+				   limit, nthreads, perr, pneval, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+/**
+ * nintegrate_gk:
+ * @f : pointer to integrand
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @rule : GK15 or GK21
+ * @epsabs : requested absolute error
+ * @epsrel : requested relative error
+ * @limit : maximal number of subintervals
+ * @nthreads : number of threads evaluating the integrand
+ * @perr : error estimate of the result, may be NULL
+ * @pneval : number of evaluations of @f, may be NULL
+ *
+ * Same as nintegrate_gk_vec() for a plain function.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_gk(double (*f)(double), double a, double b,
+		     enum gk_rule rule, double epsabs, double epsrel,
+		     int limit, int nthreads, double *perr, int *pneval)
+{
+	assert(f != NULL);
+	return nintegrate_gk_vec(vec_scalar, &f, a, b, rule, epsabs, epsrel,
+				 limit, nthreads, perr, pneval);
+}
@@ -0,0 +1,26 @@
+/* Adaptive Gauss-Kronrod integration, see gauss_kronrod.c */
+
+#ifndef GAUSS_KRONROD_H
+#define GAUSS_KRONROD_H
+
+#include "vecmath.h"
+#include "workspace.h"
+
+enum gk_rule {
+	GK15,		/* 7-point Gauss, 15-point Kronrod */
+	GK21,		/* 10-point Gauss, 21-point Kronrod */
+};
+
+size_t nintegrate_gk_workspace(int limit, int nthreads);
+double nintegrate_gk_vec_ws(vec_fn fv, void *data, double a, double b,
+			    enum gk_rule rule, double epsabs, double epsrel,
+			    int limit, int nthreads, double *perr, int *pneval,
+			    struct workspace *ws);
+double nintegrate_gk_vec(vec_fn fv, void *data, double a, double b,
+			 enum gk_rule rule, double epsabs, double epsrel,
+			 int limit, int nthreads, double *perr, int *pneval);
+double nintegrate_gk(double (*f)(double), double a, double b,
+		     enum gk_rule rule, double epsabs, double epsrel,
+		     int limit, int nthreads, double *perr, int *pneval);
+
+#endif /* GAUSS_KRONROD_H */
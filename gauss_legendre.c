@@ -0,0 +1,537 @@
+/* Implements Gauss-Legendre quadrature and tensor-product cubature
+ * over intervals, rectangles and boxes
+ *
+ * Nodes and weights of each order are computed once and cached for the
+ * life of the process; orders up to GL_TABLE_MAXORDER come from a
+ * table compiled in below.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#undef NDEBUG
+#include <assert.h>
+#include "gauss_legendre.h"
+#include "telemetry.h"
+
+#define GL_TABLE_MAXORDER	20
+
+/*
+ * Nonnegative nodes on [-1, 1] in decreasing order and their weights,
+ * for n = 1..GL_TABLE_MAXORDER, (n+1)/2 entries each.
+ */
+static const double gl_table[][2] = {
+	/* n = 1 */
+	{0.000000000000000000000, 2.000000000000000000000},
+	/* n = 2 */
+	{0.577350269189625764509, 1.000000000000000000000},
+	/* n = 3 */
+	{0.774596669241483377036, 0.555555555555555555556},
+	{0.000000000000000000000, 0.888888888888888888889},
+	/* n = 4 */
+	{0.861136311594052575224, 0.347854845137453857373},
+	{0.339981043584856264803, 0.652145154862546142627},
+	/* n = 5 */
+	{0.906179845938663992798, 0.236926885056189087514},
+	{0.538469310105683091036, 0.478628670499366468041},
+	{0.000000000000000000000, 0.568888888888888888889},
+	/* n = 6 */
+	{0.932469514203152027812, 0.171324492379170345040},
+	{0.661209386466264513661, 0.360761573048138607570},
+	{0.238619186083196908631, 0.467913934572691047390},
+	/* n = 7 */
+	{0.949107912342758524526, 0.129484966168869693271},
+	{0.741531185599394439864, 0.279705391489276667901},
+	{0.405845151377397166907, 0.381830050505118944950},
+	{0.000000000000000000000, 0.417959183673469387755},
+	/* n = 8 */
+	{0.960289856497536231684, 0.101228536290376259153},
+	{0.796666477413626739592, 0.222381034453374470544},
+	{0.525532409916328985818, 0.313706645877887287338},
+	{0.183434642495649804939, 0.362683783378361982965},
+	/* n = 9 */
+	{0.968160239507626089836, 0.081274388361574411972},
+	{0.836031107326635794299, 0.180648160694857404058},
+	{0.613371432700590397309, 0.260610696402935462319},
+	{0.324253423403808929039, 0.312347077040002840069},
+	{0.000000000000000000000, 0.330239355001259763165},
+	/* n = 10 */
+	{0.973906528517171720078, 0.066671344308688137594},
+	{0.865063366688984510732, 0.149451349150580593146},
+	{0.679409568299024406234, 0.219086362515982043996},
+	{0.433395394129247190799, 0.269266719309996355091},
+	{0.148874338981631210885, 0.295524224714752870174},
+	/* n = 11 */
+	{0.978228658146056992804, 0.055668567116173666483},
+	{0.887062599768095299075, 0.125580369464904624635},
+	{0.730152005574049324093, 0.186290210927734251426},
+	{0.519096129206811815926, 0.233193764591990479919},
+	{0.269543155952344972332, 0.262804544510246662181},
+	{0.000000000000000000000, 0.272925086777900630714},
+	/* n = 12 */
+	{0.981560634246719250691, 0.047175336386511827195},
+	{0.904117256370474856678, 0.106939325995318430960},
+	{0.769902674194304687037, 0.160078328543346226335},
+	{0.587317954286617447297, 0.203167426723065921749},
+	{0.367831498998180193753, 0.233492536538354808761},
+	{0.125233408511468915472, 0.249147045813402785001},
+	/* n = 13 */
+	{0.984183054718588149473, 0.040484004765315879520},
+	{0.917598399222977965207, 0.092121499837728447914},
+	{0.801578090733309912794, 0.138873510219787238464},
+	{0.642349339440340220644, 0.178145980761945738280},
+	{0.448492751036446852878, 0.207816047536888502313},
+	{0.230458315955134794066, 0.226283180262897238412},
+	{0.000000000000000000000, 0.232551553230873910195},
+	/* n = 14 */
+	{0.986283808696812338842, 0.035119460331751863032},
+	{0.928434883663573517336, 0.080158087159760209806},
+	{0.827201315069764993190, 0.121518570687903184689},
+	{0.687292904811685470148, 0.157203167158193534570},
+	{0.515248636358154091965, 0.185538397477937813742},
+	{0.319112368927889760436, 0.205198463721295603966},
+	{0.108054948707343662066, 0.215263853463157790196},
+	/* n = 15 */
+	{0.987992518020485428490, 0.030753241996117268355},
+	{0.937273392400705904308, 0.070366047488108124709},
+	{0.848206583410427216201, 0.107159220467171935012},
+	{0.724417731360170047416, 0.139570677926154314448},
+	{0.570972172608538847537, 0.166269205816993933553},
+	{0.394151347077563369897, 0.186161000015562211027},
+	{0.201194093997434522301, 0.198431485327111576456},
+	{0.000000000000000000000, 0.202578241925561272881},
+	/* n = 16 */
+	{0.989400934991649932596, 0.027152459411754094852},
+	{0.944575023073232576078, 0.062253523938647892863},
+	{0.865631202387831743880, 0.095158511682492784810},
+	{0.755404408355003033895, 0.124628971255533872052},
+	{0.617876244402643748447, 0.149595988816576732082},
+	{0.458016777657227386342, 0.169156519395002538189},
+	{0.281603550779258913230, 0.182603415044923588867},
+	{0.095012509837637440185, 0.189450610455068496285},
+	/* n = 17 */
+	{0.990575475314417335675, 0.024148302868547931960},
+	{0.950675521768767761223, 0.055459529373987201129},
+	{0.880239153726985902123, 0.085036148317179180884},
+	{0.781514003896801406925, 0.111883847193403971095},
+	{0.657671159216690765850, 0.135136368468525473286},
+	{0.512690537086476967886, 0.154045761076810288081},
+	{0.351231763453876315297, 0.168004102156450044510},
+	{0.178484181495847855851, 0.176562705366992646325},
+	{0.000000000000000000000, 0.179446470356206525458},
+	/* n = 18 */
+	{0.991565168420930946730, 0.021616013526483310313},
+	{0.955823949571397755181, 0.049714548894969796453},
+	{0.892602466497555739206, 0.076425730254889056529},
+	{0.803704958972523115682, 0.100942044106287165563},
+	{0.691687043060353207875, 0.122555206711478460185},
+	{0.559770831073947534608, 0.140642914670650651205},
+	{0.411751161462842646036, 0.154684675126265244925},
+	{0.251886225691505509589, 0.164276483745832722986},
+	{0.084775013041735301242, 0.169142382963143591841},
+	/* n = 19 */
+	{0.992406843843584403189, 0.019461788229726477036},
+	{0.960208152134830030853, 0.044814226765699600333},
+	{0.903155903614817901643, 0.069044542737641226581},
+	{0.822714656537142824979, 0.091490021622449999464},
+	{0.720966177335229378617, 0.111566645547333994716},
+	{0.600545304661681023470, 0.128753962539336227676},
+	{0.464570741375960945717, 0.142606702173606611776},
+	{0.316564099963629831990, 0.152766042065859666779},
+	{0.160358645640225375868, 0.158968843393954347650},
+	{0.000000000000000000000, 0.161054449848783695979},
+	/* n = 20 */
+	{0.993128599185094924786, 0.017614007139152118312},
+	{0.963971927277913791268, 0.040601429800386941331},
+	{0.912234428251325905868, 0.062672048334109063570},
+	{0.839116971822218823395, 0.083276741576704748725},
+	{0.746331906460150792614, 0.101930119817240435037},
+	{0.636053680726515025453, 0.118194531961518417312},
+	{0.510867001950827098004, 0.131688638449176626898},
+	{0.373706088715419560673, 0.142096109318382051329},
+	{0.227785851141645078080, 0.149172986472603746788},
+	{0.076526521133497333755, 0.152753387130725850698},
+};
+
+static struct gl_rule *gl_cache[GL_MAXORDER+1];
+static pthread_mutex_t gl_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Newton's iteration on P_n, in long double, for the positive half */
+static void gl_compute(int n, double x[], double w[])
+{
+	long double z, dz, p0, p1, p2, dp;
+	int i, j, k;
+
+	for (i = 0; i < (n + 1) / 2; i++) {
+		z = cosl(M_PI * (i + 0.75) / (n + 0.5));
+		for (k = 0; k < 100; k++) {
+			p0 = 1.0;
+			p1 = z;
+			for (j = 2; j <= n; j++) {
+				p2 = ((2 * j - 1) * z * p1 - (j - 1) * p0) / j;
+				p0 = p1;
+				p1 = p2;
+			}
+			dp = n * (z * p1 - p0) / (z * z - 1.0);
+			dz = p1 / dp;
+			z -= dz;
+			if (fabsl(dz) < 1e-19)
+				break;
+		}
+		if (n % 2 == 1 && i == n / 2)
+			z = 0.0;
+		x[n-1-i] = z;
+		x[i] = -z;
+		w[i] = w[n-1-i] = 2.0 / ((1.0 - z * z) * dp * dp);
+	}
+}
+
+/**
+ * gl_rule_get:
+ * @n : order of the rule, 1..GL_MAXORDER
+ *
+ * Looks up the n-point Gauss-Legendre rule, building it on first use
+ * either from the compiled-in table or by Newton's iteration.  Rules
+ * are never freed.  Thread safe.
+ *
+ * Returns: The rule, NULL if @n is out of range or out of memory
+ */
+const struct gl_rule *gl_rule_get(int n)
+{
+	struct gl_rule *r;
+	int i, off;
+
+	if (n < 1 || n > GL_MAXORDER)
+		return NULL;
+
+	pthread_mutex_lock(&gl_cache_lock);
+	r = gl_cache[n];
+	if (r == NULL) {
+		r = malloc(sizeof(*r) + 2 * n * sizeof(double));
+		if (r == NULL)
+			goto out;
+		r->n = n;
+		r->x = (double *) (r + 1);
+		r->w = r->x + n;
+		if (n <= GL_TABLE_MAXORDER) {
+			for (off = 0, i = 1; i < n; i++)
+				off += (i + 1) / 2;
+			for (i = 0; i < (n + 1) / 2; i++) {
+				r->x[n-1-i] = gl_table[off+i][0];
+				r->x[i] = -gl_table[off+i][0];
+				r->w[i] = r->w[n-1-i] = gl_table[off+i][1];
+			}
+		} else {
+			gl_compute(n, r->x, r->w);
+		}
+		gl_cache[n] = r;
+	}
+out:
+	pthread_mutex_unlock(&gl_cache_lock);
+	return r;
+}
+
+/*
+ * Composite rule: @r on each of @nsub equal parts of [a, b].
+ * Fills nsub * r->n nodes and weights.
+ */
+static void gl_composite(const struct gl_rule *r, double a, double b,
+			 int nsub, double x[], double w[])
+{
+	double h = (b - a) / nsub, mid;
+	int i, j;
+
+	for (i = 0; i < nsub; i++) {
+		mid = a + (i + 0.5) * h;
+		for (j = 0; j < r->n; j++) {
+			x[i * r->n + j] = mid + 0.5 * h * r->x[j];
+			w[i * r->n + j] = 0.5 * h * r->w[j];
+		}
+	}
+}
+
+/**
+ * nintegrate_gl_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of subintervals
+ * @order : number of Gauss-Legendre nodes per subinterval
+ * @ws : workspace for the nodes and weights
+ *
+ * Performs composite Gauss-Legendre integration, passing all
+ * n * order nodes to @fv in one call.
+ *
+ * Returns: Result of integration, NaN if @order is out of range
+ * or @ws is too small
+ */
+double nintegrate_gl_vec_ws(vec_fn fv, void *data,
+			    double a, double b, int n, int order,
+			    struct workspace *ws)
+{
+	const struct gl_rule *r = gl_rule_get(order);
+	size_t mark = workspace_mark(ws);
+	double *x = workspace_alloc(ws, 2 * (size_t) n * order, sizeof(*x));
+	double *w = x + (size_t) n * order;
+	double sum = NAN;
+	int i;
+	struct telemetry_call tm;
+
+	assert(fv != NULL);
+	assert(n >= 1);
+	if (r == NULL || x == NULL)
+		goto out;
+
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_GL);
+	gl_composite(r, a, b, n, x, w);
+	fv(n * order, x, x, data);
+	sum = 0.0;
+	for (i = 0; i < n * order; i++)
+		sum += w[i] * x[i];
+	telemetry_evals(&tm, (long) n * order);
+	telemetry_bytes(&tm, ws->used - mark);
+	telemetry_end(&tm);
+out:
+	workspace_release(ws, mark);
+	return sum;
+}
+
+/*
+ * Sums w[j] * f(x, y[j]) for a fixed x over j = 0..ny-1, in batches.
+ */
+static double gl_row_2d(vec_fn_2d fv, void *data, double x,
+			const double y[], const double w[], int ny)
+{
+	double xs[VEC_CHUNK], v[VEC_CHUNK];
+	double sum = 0.0;
+	int j, j0, jn;
+
+	for (j = 0; j < VEC_CHUNK; j++)
+		xs[j] = x;
+	for (j0 = 0; j0 < ny; j0 += VEC_CHUNK) {
+		jn = ny - j0 < VEC_CHUNK ? ny - j0 : VEC_CHUNK;
+		fv(jn, xs, y + j0, v, data);
+		for (j = 0; j < jn; j++)
+			sum += w[j0 + j] * v[j];
+	}
+	return sum;
+}
+
+/**
+ * nintegrate_gl_2d_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left x boundary of integrating rectangle
+ * @b : right x boundary of integrating rectangle
+ * @n : number of subintervals in x direction
+ * @c : left y boundary of integrating rectangle
+ * @d : right y boundary of integrating rectangle
+ * @m : number of subintervals in y direction
+ * @order : number of Gauss-Legendre nodes per subinterval and direction
+ * @ws : workspace for the nodes and weights
+ *
+ * Performs tensor-product composite Gauss-Legendre integration on
+ * [a, b] * [c, d].  Only the nodes of each direction are stored; each
+ * x node is paired with the y nodes VEC_CHUNK at a time.
+ *
+ * Returns: Result of integration, NaN if @order is out of range
+ * or @ws is too small
+ */
+double nintegrate_gl_2d_vec_ws(vec_fn_2d fv, void *data,
+			       double a, double b, int n,
+			       double c, double d, int m, int order,
+			       struct workspace *ws)
+{
+	const struct gl_rule *r = gl_rule_get(order);
+	int nx = n * order, ny = m * order;
+	size_t mark = workspace_mark(ws);
+	double *x = workspace_alloc(ws, 2 * ((size_t) nx + ny), sizeof(*x));
+	double *wx = x + nx, *y = wx + nx, *wy = y + ny;
+	double sum = NAN;
+	int i;
+	struct telemetry_call tm;
+
+	assert(fv != NULL);
+	assert(n >= 1 && m >= 1);
+	if (r == NULL || x == NULL)
+		goto out;
+
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_GL);
+	gl_composite(r, a, b, n, x, wx);
+	gl_composite(r, c, d, m, y, wy);
+	sum = 0.0;
+	for (i = 0; i < nx; i++)
+		sum += wx[i] * gl_row_2d(fv, data, x[i], y, wy, ny);
+	telemetry_evals(&tm, (long) nx * ny);
+	telemetry_bytes(&tm, ws->used - mark);
+	telemetry_end(&tm);
+out:
+	workspace_release(ws, mark);
+	return sum;
+}
+
+/**
+ * nintegrate_gl_3d_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left x boundary of integrating box
+ * @b : right x boundary of integrating box
+ * @n : number of subintervals in x direction
+ * @c : left y boundary of integrating box
+ * @d : right y boundary of integrating box
+ * @m : number of subintervals in y direction
+ * @p : left z boundary of integrating box
+ * @q : right z boundary of integrating box
+ * @l : number of subintervals in z direction
+ * @order : number of Gauss-Legendre nodes per subinterval and direction
+ * @ws : workspace for the nodes and weights
+ *
+ * Performs tensor-product composite Gauss-Legendre integration on
+ * [a, b] * [c, d] * [p, q].  Each (x, y) node pair is combined with
+ * the z nodes VEC_CHUNK at a time.
+ *
+ * Returns: Result of integration, NaN if @order is out of range
+ * or @ws is too small
+ */
+double nintegrate_gl_3d_vec_ws(vec_fn_3d fv, void *data,
+			       double a, double b, int n,
+			       double c, double d, int m,
+			       double p, double q, int l, int order,
+			       struct workspace *ws)
+{
+	const struct gl_rule *r = gl_rule_get(order);
+	int nx = n * order, ny = m * order, nz = l * order;
+	size_t mark = workspace_mark(ws);
+	double *x = workspace_alloc(ws, 2 * ((size_t) nx + ny + nz),
+				    sizeof(*x));
+	double *wx = x + nx, *y = wx + nx, *wy = y + ny;
+	double *z = wy + ny, *wz = z + nz;
+	double xs[VEC_CHUNK], ys[VEC_CHUNK], v[VEC_CHUNK];
+	double sum = NAN, sxy, sz;
+	int i, j, k, k0, kn;
+	struct telemetry_call tm;
+
+	assert(fv != NULL);
+	assert(n >= 1 && m >= 1 && l >= 1);
+	if (r == NULL || x == NULL)
+		goto out;
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_GL);
+
+	gl_composite(r, a, b, n, x, wx);
+	gl_composite(r, c, d, m, y, wy);
+	gl_composite(r, p, q, l, z, wz);
+	sum = 0.0;
+	for (i = 0; i < nx; i++) {
+		sxy = 0.0;
+		for (j = 0; j < ny; j++) {
+			for (k = 0; k < VEC_CHUNK; k++) {
+				xs[k] = x[i];
+				ys[k] = y[j];
+			}
+			sz = 0.0;
+			for (k0 = 0; k0 < nz; k0 += VEC_CHUNK) {
+				kn = nz - k0 < VEC_CHUNK ? nz - k0 : VEC_CHUNK;
+				fv(kn, xs, ys, z + k0, v, data);
+				for (k = 0; k < kn; k++)
+					sz += wz[k0 + k] * v[k];
+			}
+			sxy += wy[j] * sz;
+		}
+		sum += wx[i] * sxy;
+	}
+	telemetry_evals(&tm, (long) nx * ny * nz);
+	telemetry_bytes(&tm, ws->used - mark);
+	telemetry_end(&tm);
+out:
+	workspace_release(ws, mark);
+	return sum;
+}
+
+/**
+ * nintegrate_gl_workspace:
+ * @order : number of Gauss-Legendre nodes per subinterval and direction
+ * @nsub : total number of subintervals over all directions,
+ * n for nintegrate_gl_vec_ws(), n + m for nintegrate_gl_2d_vec_ws(),
+ * n + m + l for nintegrate_gl_3d_vec_ws()
+ *
+ * Returns: Bytes of workspace needed for the nodes and weights
+ */
+size_t nintegrate_gl_workspace(int order, int nsub)
+{
+	return workspace_size(2 * (size_t) nsub * order, sizeof(double));
+}
+
+/*
+ * Same as the _ws versions above with a workspace of their own,
+ * NaN if out of memory
+ */
+double nintegrate_gl_vec(vec_fn fv, void *data,
+			 double a, double b, int n, int order)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_gl_workspace(order, n)))
+		return nan("out of memory");
+	res = nintegrate_gl_vec_ws(fv, data, a, b, n, order, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+double nintegrate_gl_2d_vec(vec_fn_2d fv, void *data,
+			    double a, double b, int n,
+			    double c, double d, int m, int order)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_gl_workspace(order, n + m)))
+		return nan("out of memory");
+	res = nintegrate_gl_2d_vec_ws(fv, data, a, b, n, c, d, m, order, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+double nintegrate_gl_3d_vec(vec_fn_3d fv, void *data,
+			    double a, double b, int n,
+			    double c, double d, int m,
+			    double p, double q, int l, int order)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_gl_workspace(order, n + m + l)))
+		return nan("out of memory");
+	res = nintegrate_gl_3d_vec_ws(fv, data, a, b, n, c, d, m,
+				      p, q, l, order, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+/* Same as the _vec versions above for plain functions */
+double nintegrate_gl(double (*f)(double),
+		     double a, double b, int n, int order)
+{
+	assert(f != NULL);
+	return nintegrate_gl_vec(vec_scalar, &f, a, b, n, order);
+}
+
+double nintegrate_gl_2d(double (*f)(double, double),
+			double a, double b, int n,
+			double c, double d, int m, int order)
+{
+	assert(f != NULL);
+	return nintegrate_gl_2d_vec(vec_scalar_2d, &f, a, b, n, c, d, m,
+				    order);
+}
+
+double nintegrate_gl_3d(double (*f)(double, double, double),
+			double a, double b, int n,
+			double c, double d, int m,
+			double p, double q, int l, int order)
+{
+	assert(f != NULL);
+	return nintegrate_gl_3d_vec(vec_scalar_3d, &f, a, b, n, c, d, m,
+				    p, q, l, order);
+}
@@ -0,0 +1,52 @@
+/* Gauss-Legendre quadrature and tensor-product cubature,
+ * see gauss_legendre.c */
+
+#ifndef GAUSS_LEGENDRE_H
+#define GAUSS_LEGENDRE_H
+
+#include "vecmath.h"
+#include "workspace.h"
+
+#define GL_MAXORDER	256
+
+struct gl_rule {
+	int n;
+	double *x;	/* nodes on [-1, 1], increasing */
+	double *w;
+};
+
+const struct gl_rule *gl_rule_get(int n);
+
+size_t nintegrate_gl_workspace(int order, int nsub);
+double nintegrate_gl_vec_ws(vec_fn fv, void *data,
+			    double a, double b, int n, int order,
+			    struct workspace *ws);
+double nintegrate_gl_2d_vec_ws(vec_fn_2d fv, void *data,
+			       double a, double b, int n,
+			       double c, double d, int m, int order,
+			       struct workspace *ws);
+double nintegrate_gl_3d_vec_ws(vec_fn_3d fv, void *data,
+			       double a, double b, int n,
+			       double c, double d, int m,
+			       double p, double q, int l, int order,
+			       struct workspace *ws);
+double nintegrate_gl_vec(vec_fn fv, void *data,
+			 double a, double b, int n, int order);
+double nintegrate_gl_2d_vec(vec_fn_2d fv, void *data,
+			    double a, double b, int n,
+			    double c, double d, int m, int order);
+double nintegrate_gl_3d_vec(vec_fn_3d fv, void *data,
+			    double a, double b, int n,
+			    double c, double d, int m,
+			    double p, double q, int l, int order);
+double nintegrate_gl(double (*f)(double),
+		     double a, double b, int n, int order);
+double nintegrate_gl_2d(double (*f)(double, double),
+			double a, double b, int n,
+			double c, double d, int m, int order);
+double nintegrate_gl_3d(double (*f)(double, double, double),
+			double a, double b, int n,
+			double c, double d, int m,
+			double p, double q, int l, int order);
+
+#endif /* GAUSS_LEGENDRE_H */
@@ -5,97 +5,171 @@
  * Lab Assignment 06, PB09203226
  */
 
-#include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#undef NDEBUG
+#include <assert.h>
+#include "iterative.h"
+#include "telemetry.h"
 
-#define MAXREPT	409600
-void lsolve_sor(double *pA, double *Y, double *X, double omega,
-		int n, double epsilon, int *pnstep)
+/*
+ * One SOR sweep over X in a single pass: the new X[j] is formed from
+ * the precomputed inverse diagonal and written back at once, and the
+ * largest change of an entry is tracked on the way.
+ */
+static double sor_sweep(int n, const double A[][n], const double Y[],
+			const double dinv[], double X[], double omega)
+{
+	double sum, x, norm_inf = 0.0;
+	int j, k;
+
+	for (j = 0; j < n; j++) {
+		sum = Y[j];
+		for (k = 0; k < j; k++)
+			sum -= A[j][k] * X[k];
+		for (k = j + 1; k < n; k++)
+			sum -= A[j][k] * X[k];
+		x = (1 - omega) * X[j] + omega * sum * dinv[j];
+		if (fabs(x - X[j]) > norm_inf)
+			norm_inf = fabs(x - X[j]);
+		X[j] = x;
+	}
+	return norm_inf;
+}
+
+/* ||Y - AX|| in the infinity norm */
+static double sor_residual(int n, const double A[][n], const double Y[],
+			   const double X[])
+{
+	double sum, res_inf = 0.0;
+	int j, k;
+
+	for (j = 0; j < n; j++) {
+		sum = Y[j];
+		for (k = 0; k < n; k++)
+			sum -= A[j][k] * X[k];
+		if (fabs(sum) > res_inf)
+			res_inf = fabs(sum);
+	}
+	return res_inf;
+}
+
+/* Returns the bytes of workspace lsolve_sor_ws() and
+ * lsolve_sor_check_ws() need for @n unknowns
+ */
+size_t lsolve_sor_workspace(int n)
 {
-	int i, j, k;
-	double sum, norm_inf;
+	return workspace_size(n, sizeof(double));
+}
+
+/**
+ * lsolve_sor_check_ws:
+ * @pA : n * n matrix A, row-major
+ * @Y : right-hand side
+ * @X : initial guess, replaced by the solution
+ * @omega : relaxation factor, 1 for Gauss-Seidel
+ * @n : number of unknowns
+ * @epsilon : stop when no entry of X changes by more than this in a
+ * sweep, 0 to test the residual only
+ * @restol : stop when ||Y - AX|| <= @restol * ||Y|| (infinity norms),
+ * 0 to test the update only
+ * @every : test for convergence after every @every sweeps only
+ * @pnstep : number of sweeps done, 0 if @ws is too small
+ * @ws : workspace for the inverse diagonal
+ *
+ * Solves AX = Y with SOR.  Each sweep is one pass over A that also
+ * yields the size of the update, so testing @epsilon is nearly free;
+ * the residual costs another pass over A, which @every > 1 spreads over
+ * several sweeps.  Stops on whichever test passes first.
+ *
+ * Modifies X.	No return value.
+ */
+void lsolve_sor_check_ws(double *pA, double *Y, double *X, double omega,
+			 int n, double epsilon, double restol, int every,
+			 int *pnstep, struct workspace *ws)
+{
+	int i, j;
+	double norm_inf, res_inf, y_inf = 0.0;
 	double (*A)[n] = (double (*)[n]) pA;
-	double *old = malloc(n * sizeof(*old));
+	size_t mark = workspace_mark(ws);
+	double *dinv = workspace_alloc(ws, n, sizeof(*dinv));
+	struct telemetry_call tm;
 
-	for (i = 0; i < MAXREPT; i++) {
-		for (j = 0; j < n; j++) {
-			old[j] = X[j];
-		}
-		for (j = 0; j < n; j++) {
-			sum = Y[j] / A[j][j];
-			for (k = 0; k < n; k++) {
-				if (k != j) {
-					sum -= A[j][k] * X[k] / A[j][j];
-				}
-			}
-			X[j] = (1 - omega) * old[j] + omega * sum;
-		}
-		norm_inf = 0;
-		for (j = 0; j < n; j++) {
-			if (fabs(X[j] - old[j]) > norm_inf)
-				norm_inf = fabs(X[j] - old[j]);
-		}
+	assert(every >= 1);
+	if (dinv == NULL) {
+		*pnstep = 0;
+		return;
+	}
+	telemetry_begin(&tm, TELEMETRY_LSOLVE_SOR);
+	telemetry_bytes(&tm, ws->used - mark);
+	for (j = 0; j < n; j++) {
+		dinv[j] = 1.0 / A[j][j];
+		if (fabs(Y[j]) > y_inf)
+			y_inf = fabs(Y[j]);
+	}
+
+	for (i = 0; i < LSOLVE_MAXREPT; i++) {
+		norm_inf = sor_sweep(n, A, Y, dinv, X, omega);
+		telemetry_iter(&tm, norm_inf);
+		if ((i + 1) % every != 0)
+			continue;
 		if (norm_inf < epsilon)
 			break;
+		if (restol > 0) {
+			res_inf = sor_residual(n, A, Y, X);
+			telemetry_residual(&tm, res_inf);
+			if (res_inf <= restol * y_inf)
+				break;
+		}
 	}
 
 	*pnstep = i+1;
-	free(old);
+	workspace_release(ws, mark);
+	telemetry_end(&tm);
 }
 
-void lsolve_gauss(double *pA, double *Y, double *X,
-		  int n, double epsilon, int *pnstep)
+/*
+ * Same as lsolve_sor() with the scratch vector taken from @ws.
+ * *pnstep is 0 and X untouched if @ws is too small.
+ */
+void lsolve_sor_ws(double *pA, double *Y, double *X, double omega,
+		   int n, double epsilon, int *pnstep, struct workspace *ws)
 {
-	lsolve_sor(pA, Y, X, 1, n, epsilon, pnstep);
+	lsolve_sor_check_ws(pA, Y, X, omega, n, epsilon, 0, 1, pnstep, ws);
 }
 
-#define arr_len(x)	(sizeof(x)/sizeof(*(x)))
-#define EPSILON	1e-13
-
-#define test_sor(omega, ns)		do {				\
-		double __X[9];						\
-		int __i;						\
-		for (__i = 0; __i < arr_len(__X); __i++) {		\
-			__X[__i] = 0;					\
-		}							\
-		lsolve_sor((double *) A, Y, __X, omega,			\
-			   arr_len(__X), EPSILON, &ns);			\
-		printf("Omega = %.2f, Steps = %d\n", omega, ns);	\
-	} while (0)
-
-int main(void)
+/* Same as lsolve_sor_check_ws(), 0 steps if out of memory */
+void lsolve_sor_check(double *pA, double *Y, double *X, double omega,
+		      int n, double epsilon, double restol, int every,
+		      int *pnstep)
 {
-	double A[][9] = {{31, -13, 0, 0, 0, -10, 0, 0, 0},
-			  {-13, 35, -9, 0, -11, 0, 0, 0, 0},
-			  {0, -9, 31, -10, 0, 0, 0, 0, 0},
-			  {0, 0, -10, 79, -30, 0, 0, 0, -9},
-			  {0, 0, 0, -30, 57, -7, 0, -5, 0},
-			  {0, 0, 0, 0, -7, 47, -30, 0, 0},
-			  {0, 0, 0, 0, 0, -30, 41, 0, 0},
-			  {0, 0, 0, 0, -5, 0, 0, 27, -2},
-			  {0, 0, 0, -9, 0, 0, 0, -2, 29}};
-	double Y[9] = {-15, 27, -23, 0, -20, 12, -7, 7, 10};
-	double X[9] = {0};
-	int i, nstep, min_nstep = MAXREPT;
-	double min_omega;
-
-	printf("Gauss-Seidel Iteration:\n");
-	lsolve_gauss((double *) A, Y, X, arr_len(X), EPSILON, &nstep);
-	printf("Roots = \n");
-	for (i = 0; i < arr_len(X); i++)
-		printf("%.13f\n", X[i]);
-	printf("Steps = %d\n", nstep);
-
-	printf("\nSOR Iteration:\n");
-	for (i = 1; i <= 99; i++) {
-		test_sor((double) i / 50.0, nstep);
-		if (min_nstep > nstep) {
-			min_nstep = nstep;
-			min_omega = (double) i / 50.0;
-		}
+	struct workspace ws;
+
+	if (workspace_init(&ws, lsolve_sor_workspace(n))) {
+		*pnstep = 0;
+		return;
 	}
-	printf("Best omega = %.2f\n", min_omega);
+	lsolve_sor_check_ws(pA, Y, X, omega, n, epsilon, restol, every,
+			    pnstep, &ws);
+	workspace_destroy(&ws);
+}
+
+/* *pnstep is 0 and X untouched if out of memory */
+void lsolve_sor(double *pA, double *Y, double *X, double omega,
+		int n, double epsilon, int *pnstep)
+{
+	lsolve_sor_check(pA, Y, X, omega, n, epsilon, 0, 1, pnstep);
+}
 
-	return 0;
+/* Gauss-Seidel is SOR with omega = 1, @ws sized by lsolve_sor_workspace() */
+void lsolve_gauss_ws(double *pA, double *Y, double *X,
+		     int n, double epsilon, int *pnstep, struct workspace *ws)
+{
+	lsolve_sor_ws(pA, Y, X, 1, n, epsilon, pnstep, ws);
+}
+
+void lsolve_gauss(double *pA, double *Y, double *X,
+		  int n, double epsilon, int *pnstep)
+{
+	lsolve_sor(pA, Y, X, 1, n, epsilon, pnstep);
 }
@@ -0,0 +1,26 @@
+/* Gauss-Seidel and SOR iterations for linear equations, see iterative.c */
+
+#ifndef ITERATIVE_H
+#define ITERATIVE_H
+
+#include "workspace.h"
+
+#define LSOLVE_MAXREPT	409600
+
+size_t lsolve_sor_workspace(int n);
+void lsolve_sor_check_ws(double *pA, double *Y, double *X, double omega,
+			 int n, double epsilon, double restol, int every,
+			 int *pnstep, struct workspace *ws);
+void lsolve_sor_check(double *pA, double *Y, double *X, double omega,
+		      int n, double epsilon, double restol, int every,
+		      int *pnstep);
+void lsolve_sor_ws(double *pA, double *Y, double *X, double omega,
+		   int n, double epsilon, int *pnstep, struct workspace *ws);
+void lsolve_sor(double *pA, double *Y, double *X, double omega,
+		int n, double epsilon, int *pnstep);
+void lsolve_gauss_ws(double *pA, double *Y, double *X,
+		     int n, double epsilon, int *pnstep, struct workspace *ws);
+void lsolve_gauss(double *pA, double *Y, double *X,
+		  int n, double epsilon, int *pnstep);
+
+#endif /* ITERATIVE_H */
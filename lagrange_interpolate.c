@@ -3,9 +3,9 @@
  * Implements Lagrange Interpolate
  */
 
-#include <stdio.h>
-#include <stdlib.h>
 #include <math.h>
+#include "lagrange_interpolate.h"
+#include "telemetry.h"
 
 /* Do Lagrange interpolation */
 long double lagrange_interpolate(
@@ -26,6 +26,21 @@ long double lagrange_interpolate(
 	return res;
 }
 
+struct grid_fns {
+	long double (*fgen)(int, int);
+	long double (*fcn)(long double);
+};
+
+static long double grid_fgen(int i, int n, void *ctx)
+{
+	return ((struct grid_fns *) ctx)->fgen(i, n);
+}
+
+static long double grid_fcn(long double x, void *ctx)
+{
+	return ((struct grid_fns *) ctx)->fcn(x);
+}
+
 /* Generates grid for interpolation
  * fgen(i, n) gives x[i], fcn(x[i]) gives y[i]
  */
@@ -33,33 +48,42 @@ void generate_grid(int n, long double vx[], long double vy[],
 		   long double (*fgen)(int, int),
 		   long double (*fcn)(long double))
 {
-	int i;
+	struct grid_fns fns = { fgen, fcn };
 
-	for (i = 0; i <= n; i++) {
-		vx[i] = fgen(i, n);
-		vy[i] = fcn(vx[i]);
-	}
+	generate_grid_ctx(n, vx, vy, grid_fgen, grid_fcn, &fns);
 }
 
-/* Computes and returns maximal error after
- * generating grid and doing interpolation
- * fgen(i, n) gives x[i], fcn(x[i]) gives y[i] (interpolating point)
- * fgeny(j) gives y[j] (sampling error)
- * On error, returns a negtive number
+/* Returns the bytes of workspace get_max_error_ws() needs for a grid
+ * of n + 1 points
  */
-long double get_max_error(int n, long double (*fgen)(int, int),
-			  long double (*fcn)(long double),
-			  int jmax, long double (*fgeny)(int))
+size_t get_max_error_workspace(int n)
+{
+	return 2 * workspace_size(n + 1, sizeof(long double));
+}
+
+/* Same as get_max_error() with the grid kept in ws
+ * Returns a negative number if ws is too small
+ */
+long double get_max_error_ws(int n, long double (*fgen)(int, int),
+			     long double (*fcn)(long double),
+			     int jmax, long double (*fgeny)(int),
+			     struct workspace *ws)
 {
 	int j;
 	long double max_err = 0.0;
 	long double err = 0.0;
 	long double y = 0.0;
-	long double *vx = malloc((n+1) * sizeof(*vx));
-	long double *vy = malloc((n+1) * sizeof(*vy));
+	size_t mark = workspace_mark(ws);
+	long double *vx = workspace_alloc(ws, n + 1, sizeof(*vx));
+	long double *vy = workspace_alloc(ws, n + 1, sizeof(*vy));
+	struct telemetry_call tm;
 
-	if (vx == NULL || vy == NULL)
+	if (vx == NULL || vy == NULL) {
+		workspace_release(ws, mark);
 		return -1.0;
+	}
+	telemetry_begin(&tm, TELEMETRY_LAGRANGE_MAX_ERROR);
+	telemetry_bytes(&tm, ws->used - mark);
 	generate_grid(n, vx, vy, fgen, fcn);
 	for (j = 0; j <= jmax; j++) {
 		y = fgeny(j);
@@ -67,42 +91,29 @@ long double get_max_error(int n, long double (*fgen)(int, int),
 		if (err > max_err)
 			max_err = err;
 	}
-	free(vx);
-	free(vy);
+	workspace_release(ws, mark);
+	telemetry_evals(&tm, (n + 1) + (jmax + 1));
+	telemetry_residual(&tm, max_err);
+	telemetry_end(&tm);
 	return max_err;
 }
 
-long double fgen_1(int i, int n)
-{
-	return -5.0 + 10.0 * i / n;
-}
-
-#define PI	(atan(1.0) * 4.0)
-long double fgen_2(int i, int n)
-{
-	return -5.0 * cos(PI * (2*i+1) / (2*n+2));
-}
-
-long double fcn(long double x)
-{
-	return 1.0 / (1.0 + x * x);
-}
-
-long double fgen_y(int i)
-{
-	return -5.0 + 0.1 * i;
-}
-
-int main(void)
+/* Computes and returns maximal error after
+ * generating grid and doing interpolation
+ * fgen(i, n) gives x[i], fcn(x[i]) gives y[i] (interpolating point)
+ * fgeny(j) gives y[j] (sampling error)
+ * On error, returns a negtive number
+ */
+long double get_max_error(int n, long double (*fgen)(int, int),
+			  long double (*fcn)(long double),
+			  int jmax, long double (*fgeny)(int))
 {
-	int i;
-
-	for (i = 5; i <= 40; i *= 2) {
-		printf("N = %d\nMax Error of grid (1): %.13Lf\n"
-		       "Max Error of grid (2): %.13Lf\n", i,
-		       get_max_error(i, fgen_1, fcn, 100, fgen_y),
-		       get_max_error(i, fgen_2, fcn, 100, fgen_y));
-	}
+	struct workspace ws;
+	long double max_err;
 
-	return 0;
+	if (workspace_init(&ws, get_max_error_workspace(n)))
+		return -1.0;
+	max_err = get_max_error_ws(n, fgen, fcn, jmax, fgeny, &ws);
+	workspace_destroy(&ws);
+	return max_err;
 }
@@ -0,0 +1,50 @@
+/* Lagrange interpolation, see lagrange_interpolate.c */
+
+#ifndef LAGRANGE_INTERPOLATE_H
+#define LAGRANGE_INTERPOLATE_H
+
+#include "callback.h"
+#include "workspace.h"
+
+/**
+ * generate_grid_ctx:
+ * @n : grid has @n + 1 points
+ * @vx : abscissae, vx[i] = fgen(i, @n, @ctx)
+ * @vy : ordinates, vy[i] = fcn(vx[i], @ctx)
+ * @fgen : generates the abscissae
+ * @fcn : function to interpolate
+ * @ctx : passed to @fgen and @fcn
+ *
+ * Generates grid for interpolation, inlined at the call site so that
+ * @fgen and @fcn can be inlined into the loop.
+ *
+ * Modifies vx and vy.	No return value.
+ */
+CB_INLINE void generate_grid_ctx(int n, long double vx[], long double vy[],
+				 long double (*fgen)(int, int, void *),
+				 long double (*fcn)(long double, void *),
+				 void *ctx)
+{
+	int i;
+
+	for (i = 0; i <= n; i++) {
+		vx[i] = fgen(i, n, ctx);
+		vy[i] = fcn(vx[i], ctx);
+	}
+}
+
+long double lagrange_interpolate(
+	long double x, int n, long double vx[], long double vy[]);
+void generate_grid(int n, long double vx[], long double vy[],
+		   long double (*fgen)(int, int),
+		   long double (*fcn)(long double));
+size_t get_max_error_workspace(int n);
+long double get_max_error_ws(int n, long double (*fgen)(int, int),
+			     long double (*fcn)(long double),
+			     int jmax, long double (*fgeny)(int),
+			     struct workspace *ws);
+long double get_max_error(int n, long double (*fgen)(int, int),
+			  long double (*fcn)(long double),
+			  int jmax, long double (*fgeny)(int));
+
+#endif /* LAGRANGE_INTERPOLATE_H */
@@ -7,6 +7,8 @@
 
 #include <stdio.h>
 #include <math.h>
+#include "lineq_solver.h"
+#include "telemetry.h"
 
 /**
  * Solves X in AX = Y
@@ -21,6 +23,9 @@ void lsolve_colmaj(double *pA, double *X, int n)
 	double (*A)[n+1] = (double (*)[n+1]) pA;
 	double tmp, factor;
 	int i, j, k, max;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_LSOLVE_COLMAJ);
 
 	for (i = 0; i < n; i++) {
 		max = i;	/* locate major row */
@@ -28,8 +33,8 @@ void lsolve_colmaj(double *pA, double *X, int n)
 			if (fabs(A[j][i]) > fabs(A[max][i]))
 				max = j;
 		}
-		if (i != max) { /* exchange i-th row and major row */
-			for (j = i; j < n; j++) {
+		if (i != max) { /* exchange i-th row and major row, with Y */
+			for (j = i; j <= n; j++) {
 				tmp = A[i][j];
 				A[i][j] = A[max][j];
 				A[max][j] = tmp;
@@ -46,26 +51,5 @@ void lsolve_colmaj(double *pA, double *X, int n)
 		for (j = i-1; j >= 0; j--)
 			A[j][n] -= X[i] * A[j][i];
 	}
-}
-
-int main(void)
-{
-	double A[][10] = {{31, -13, 0, 0, 0, -10, 0, 0, 0, -15},
-			   {-13, 35, -9, 0, -11, 0, 0, 0, 0, 27},
-			   {0, -9, 31, -10, 0, 0, 0, 0, 0, -23},
-			   {0, 0, -10, 79, -30, 0, 0, 0, -9, 0},
-			   {0, 0, 0, -30, 57, -7, 0, -5, 0, -20},
-			   {0, 0, 0, 0, -7, 47, -30, 0, 0, 12},
-			   {0, 0, 0, 0, 0, -30, 41, 0, 0, -7},
-			   {0, 0, 0, 0, -5, 0, 0, 27, -2, 7},
-			   {0, 0, 0, -9, 0, 0, 0, -2, 29, 10}};
-	double X[9];
-	lsolve_colmaj((double *)A, X, 9);
-
-	printf("Roots = \n");
-	int i;
-	for (i = 0; i < 9; i++)
-		printf("%.13f\n", X[i]);
-
-	return 0;
+	telemetry_end(&tm);
 }
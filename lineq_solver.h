@@ -0,0 +1,8 @@
+/* Gauss elimination for linear equations, see lineq_solver.c */
+
+#ifndef LINEQ_SOLVER_H
+#define LINEQ_SOLVER_H
+
+void lsolve_colmaj(double *pA, double *X, int n);
+
+#endif /* LINEQ_SOLVER_H */
@@ -0,0 +1,362 @@
+/* Implements Monte Carlo and randomized quasi-Monte Carlo integration
+ * over boxes in up to MC_MAXDIM dimensions
+ *
+ * Every random number is a hash of (seed, stream, counter), so any
+ * point of any replicate can be generated independently: blocks of
+ * points are dealt to threads and the result only depends on the seed.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#undef NDEBUG
+#include <assert.h>
+#include "monte_carlo.h"
+#include "telemetry.h"
+
+/* counter-based generator: splitmix64 finalizer over the counter */
+#define MC_GOLDEN	0x9e3779b97f4a7c15ULL
+
+static uint64_t mc_mix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static uint64_t mc_random(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+	return mc_mix(mc_mix(seed ^ mc_mix(stream + MC_GOLDEN))
+		      + counter * MC_GOLDEN);
+}
+
+/* uniform in (0, 1) */
+static double mc_uniform(uint64_t r)
+{
+	return ((r >> 11) + 0.5) * 0x1p-53;
+}
+
+static const int mc_primes[MC_MAXDIM] = {
+	2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31,
+	37, 41, 43, 47, 53, 59, 61, 67, 71, 73,
+};
+
+/*
+ * Sobol direction numbers for dimensions 2..MC_MAXDIM (Joe and Kuo):
+ * degree s of the primitive polynomial, its inner coefficients a and
+ * the initial m_1..m_s.  Dimension 1 is the van der Corput sequence.
+ */
+static const struct {
+	int s, a;
+	unsigned m[7];
+} sobol_init[MC_MAXDIM - 1] = {
+	{1, 0, {1}},
+	{2, 1, {1, 3}},
+	{3, 1, {1, 3, 1}},
+	{3, 2, {1, 1, 1}},
+	{4, 1, {1, 1, 3, 3}},
+	{4, 4, {1, 3, 5, 13}},
+	{5, 2, {1, 1, 5, 5, 17}},
+	{5, 4, {1, 1, 5, 5, 5}},
+	{5, 7, {1, 1, 7, 11, 19}},
+	{5, 11, {1, 1, 5, 1, 1}},
+	{5, 13, {1, 1, 1, 3, 11}},
+	{5, 14, {1, 3, 5, 5, 31}},
+	{6, 1, {1, 3, 3, 9, 7, 49}},
+	{6, 13, {1, 1, 1, 15, 21, 21}},
+	{6, 16, {1, 3, 1, 13, 27, 49}},
+	{6, 19, {1, 1, 1, 15, 7, 5}},
+	{6, 22, {1, 3, 1, 15, 13, 25}},
+	{6, 25, {1, 1, 5, 5, 19, 61}},
+	{7, 1, {1, 3, 7, 11, 23, 15, 103}},
+	{7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+
+#define SOBOL_BITS	32
+
+/* direction numbers v[j][k] scaled to 32 bits, k = 0..SOBOL_BITS-1 */
+static void sobol_directions(int dim, uint32_t v[][SOBOL_BITS])
+{
+	int j, k, i, s, a;
+
+	for (k = 0; k < SOBOL_BITS; k++)
+		v[0][k] = 1U << (SOBOL_BITS - 1 - k);
+	for (j = 1; j < dim; j++) {
+		s = sobol_init[j-1].s;
+		a = sobol_init[j-1].a;
+		for (k = 0; k < s; k++)
+			v[j][k] = sobol_init[j-1].m[k] << (SOBOL_BITS - 1 - k);
+		for (k = s; k < SOBOL_BITS; k++) {
+			v[j][k] = v[j][k-s] ^ (v[j][k-s] >> s);
+			for (i = 1; i < s; i++)
+				if ((a >> (s - 1 - i)) & 1)
+					v[j][k] ^= v[j][k-i];
+		}
+	}
+}
+
+/* radical inverse of i in base b */
+static double halton(uint64_t i, int b)
+{
+	double f = 1.0, r = 0.0;
+
+	while (i > 0) {
+		f /= b;
+		r += f * (i % b);
+		i /= b;
+	}
+	return r;
+}
+
+struct mc_job {
+	vec_fn_nd fv;
+	void *data;
+	int dim;
+	const double *a, *b;
+	enum mc_method method;
+	uint64_t seed;
+	long npoints;
+	long nblocks;
+	int nrep;
+	uint32_t (*v)[SOBOL_BITS];
+	double *partial;	/* nrep * nblocks block sums */
+	int nthreads;
+	int id;
+};
+
+/*
+ * Fills x[] with points i0..i0+n-1 of replicate rep, mapped to the box.
+ */
+static void mc_points(const struct mc_job *job, int rep, long i0, int n,
+		      double x[])
+{
+	int dim = job->dim, i, j;
+	uint32_t shift[MC_MAXDIM], gray[MC_MAXDIM];
+	double u, offset[MC_MAXDIM];
+	uint64_t g;
+
+	switch (job->method) {
+	case MC_PSEUDO:
+		for (i = 0; i < n; i++)
+			for (j = 0; j < dim; j++)
+				x[i*dim + j] = mc_uniform(mc_random(job->seed, rep,
+					(uint64_t) (i0 + i) * dim + j));
+		break;
+	case MC_HALTON:
+		for (j = 0; j < dim; j++)
+			offset[j] = mc_uniform(mc_random(job->seed, rep, j));
+		for (i = 0; i < n; i++) {
+			for (j = 0; j < dim; j++) {
+				u = halton(i0 + i + 1, mc_primes[j]) + offset[j];
+				x[i*dim + j] = u < 1.0 ? u : u - 1.0;
+			}
+		}
+		break;
+	case MC_SOBOL:
+		/* Gray code order: point i is the XOR of the direction
+		 * numbers selected by the bits of i ^ (i >> 1) */
+		g = i0 ^ (i0 >> 1);
+		for (j = 0; j < dim; j++) {
+			shift[j] = mc_random(job->seed, rep, j) >> 32;
+			gray[j] = 0;
+			for (i = 0; i < SOBOL_BITS; i++)
+				if ((g >> i) & 1)
+					gray[j] ^= job->v[j][i];
+		}
+		for (i = 0; i < n; i++) {
+			if (i > 0)
+				for (j = 0; j < dim; j++)
+					gray[j] ^= job->v[j][__builtin_ctzl(i0 + i)];
+			for (j = 0; j < dim; j++)
+				x[i*dim + j] = ((gray[j] ^ shift[j]) + 0.5)
+					       * 0x1p-32;
+		}
+		break;
+	}
+
+	for (i = 0; i < n; i++)
+		for (j = 0; j < dim; j++)
+			x[i*dim + j] = job->a[j]
+				       + (job->b[j] - job->a[j]) * x[i*dim + j];
+}
+
+static void *mc_worker(void *p)
+{
+	struct mc_job *job = p;
+	double x[MC_BLOCK * MC_MAXDIM], y[MC_BLOCK];
+	double sum;
+	long t, i0;
+	int rep, n, i;
+
+	for (t = job->id; t < job->nrep * job->nblocks; t += job->nthreads) {
+		rep = t / job->nblocks;
+		i0 = (t % job->nblocks) * MC_BLOCK;
+		n = job->npoints - i0 < MC_BLOCK ? job->npoints - i0 : MC_BLOCK;
+		mc_points(job, rep, i0, n, x);
+		job->fv(n, job->dim, x, y, job->data);
+		sum = 0.0;
+		for (i = 0; i < n; i++)
+			sum += y[i];
+		job->partial[t] = sum;
+	}
+	return NULL;
+}
+
+/**
+ * nintegrate_mc_workspace:
+ * @npoints : points per replicate
+ * @nrep : number of replicates
+ * @nthreads : number of threads evaluating the integrand
+ *
+ * Returns: Bytes of workspace needed by nintegrate_mc_vec_ws()
+ */
+size_t nintegrate_mc_workspace(long npoints, int nrep, int nthreads)
+{
+	long nblocks = (npoints + MC_BLOCK - 1) / MC_BLOCK;
+
+	return workspace_size(nrep * nblocks, sizeof(double))
+	       + workspace_size(MC_MAXDIM, sizeof(uint32_t [SOBOL_BITS]))
+	       + workspace_size(nthreads, sizeof(struct mc_job))
+	       + workspace_size(nthreads, sizeof(pthread_t));
+}
+
+/**
+ * nintegrate_mc_vec_ws:
+ * @fv : batched integrand, gets MC_BLOCK points per call
+ * @data : passed to @fv
+ * @dim : number of dimensions, 1..MC_MAXDIM
+ * @a : lower corner of the integrating box, @dim entries
+ * @b : upper corner of the integrating box, @dim entries
+ * @npoints : points per replicate, at most 2^32 for MC_SOBOL
+ * @nrep : number of independent replicates, at least 2
+ * @method : MC_PSEUDO, MC_HALTON or MC_SOBOL
+ * @seed : seed of the random streams
+ * @nthreads : number of threads evaluating @fv
+ * @perr : standard error of the result, INFINITY if @ws is too small,
+ * may be NULL
+ * @ws : workspace for the block sums and thread handles
+ *
+ * Performs (quasi-)Monte Carlo integration.  Each replicate uses its
+ * own randomization of the point set: a fresh stream for MC_PSEUDO, a
+ * random shift modulo 1 for MC_HALTON, a random digital shift for
+ * MC_SOBOL.  The result is the mean of the replicate estimates and the
+ * error their standard error.  The result depends on @seed only, not
+ * on @nthreads.  @fv must be thread safe when @nthreads > 1.
+ *
+ * Returns: Result of integration, NaN if @ws is too small
+ */
+double nintegrate_mc_vec_ws(vec_fn_nd fv, void *data, int dim,
+			    const double a[], const double b[],
+			    long npoints, int nrep, enum mc_method method,
+			    unsigned long long seed, int nthreads, double *perr,
+			    struct workspace *ws)
+{
+	long nblocks = (npoints + MC_BLOCK - 1) / MC_BLOCK;
+	size_t mark = workspace_mark(ws);
+	double *partial = workspace_alloc(ws, nrep * nblocks,
+					  sizeof(*partial));
+	uint32_t (*v)[SOBOL_BITS] = workspace_alloc(ws, MC_MAXDIM, sizeof(*v));
+	struct mc_job *jobs = workspace_alloc(ws, nthreads, sizeof(*jobs));
+	pthread_t *tids = workspace_alloc(ws, nthreads, sizeof(*tids));
+	double vol = 1.0, est, mean = NAN, var = INFINITY;
+	long t;
+	int i, r, nstarted;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_MC);
+	assert(fv != NULL && a != NULL && b != NULL);
+	assert(dim >= 1 && dim <= MC_MAXDIM);
+	assert(npoints >= 1 && nrep >= 2 && nthreads >= 1);
+	assert(method != MC_SOBOL || npoints <= 1L << SOBOL_BITS);
+	if (partial == NULL || v == NULL || jobs == NULL || tids == NULL)
+		goto out;
+
+	if (method == MC_SOBOL)
+		sobol_directions(dim, v);
+	for (i = 0; i < dim; i++)
+		vol *= b[i] - a[i];
+	for (i = 0; i < nthreads; i++) {
+		jobs[i] = (struct mc_job) {
+			.fv = fv, .data = data, .dim = dim, .a = a, .b = b,
+			.method = method, .seed = seed,
+			.npoints = npoints, .nblocks = nblocks, .nrep = nrep,
+			.v = v, .partial = partial,
+			.nthreads = nthreads, .id = i,
+		};
+	}
+
+	/* the caller runs job 0 and any job whose thread failed to start */
+	for (nstarted = 1; nstarted < nthreads; nstarted++) {
+		if (pthread_create(&tids[nstarted], NULL, mc_worker,
+				   &jobs[nstarted]))
+			break;
+	}
+	mc_worker(&jobs[0]);
+	for (i = nstarted; i < nthreads; i++)
+		mc_worker(&jobs[i]);
+	for (i = 1; i < nstarted; i++)
+		pthread_join(tids[i], NULL);
+
+	/* fold the block sums in a fixed order, then Welford over the
+	 * replicates */
+	mean = 0.0;
+	var = 0.0;
+	for (r = 0; r < nrep; r++) {
+		est = 0.0;
+		for (t = 0; t < nblocks; t++)
+			est += partial[r * nblocks + t];
+		est *= vol / npoints;
+		var += (est - mean) * (est - mean) * r / (r + 1);
+		mean += (est - mean) / (r + 1);
+	}
+	var /= nrep - 1;
+	telemetry_evals(&tm, npoints * nrep);
+	telemetry_residual(&tm, sqrt(var / nrep));
+
+out:
+	if (perr != NULL)
+		*perr = sqrt(var / nrep);
+	telemetry_bytes(&tm, ws->used - mark);
+	telemetry_end(&tm);
+	workspace_release(ws, mark);
+	return mean;
+}
+
+/**
+ * nintegrate_mc_vec:
+ * @fv : batched integrand, gets MC_BLOCK points per call
+ * @data : passed to @fv
+ * @dim : number of dimensions, 1..MC_MAXDIM
+ * @a : lower corner of the integrating box, @dim entries
+ * @b : upper corner of the integrating box, @dim entries
+ * @npoints : points per replicate, at most 2^32 for MC_SOBOL
+ * @nrep : number of independent replicates, at least 2
+ * @method : MC_PSEUDO, MC_HALTON or MC_SOBOL
+ * @seed : seed of the random streams
+ * @nthreads : number of threads evaluating @fv
+ * @perr : standard error of the result, may be NULL
+ *
+ * Same as nintegrate_mc_vec_ws() with a workspace of its own.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_mc_vec(vec_fn_nd fv, void *data, int dim,
+			 const double a[], const double b[],
+			 long npoints, int nrep, enum mc_method method,
+			 unsigned long long seed, int nthreads, double *perr)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_mc_workspace(npoints, nrep,
+							 nthreads))) {
+		if (perr != NULL)
+			*perr = INFINITY;
+		return nan("out of memory");
+	}
+	res = nintegrate_mc_vec_ws(fv, data, dim, a, b, npoints, nrep,
+				   method, seed, nthreads, perr, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
@@ -0,0 +1,30 @@
+/* Monte Carlo and randomized quasi-Monte Carlo integration,
+ * see monte_carlo.c */
+
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "vecmath.h"
+#include "workspace.h"
+
+#define MC_MAXDIM	21
+#define MC_BLOCK	128	/* points passed to the integrand per call */
+
+enum mc_method {
+	MC_PSEUDO,	/* plain Monte Carlo */
+	MC_HALTON,	/* Halton, random shift modulo 1 */
+	MC_SOBOL,	/* Sobol, random digital shift */
+};
+
+size_t nintegrate_mc_workspace(long npoints, int nrep, int nthreads);
+double nintegrate_mc_vec_ws(vec_fn_nd fv, void *data, int dim,
+			    const double a[], const double b[],
+			    long npoints, int nrep, enum mc_method method,
+			    unsigned long long seed, int nthreads, double *perr,
+			    struct workspace *ws);
+double nintegrate_mc_vec(vec_fn_nd fv, void *data, int dim,
+			 const double a[], const double b[],
+			 long npoints, int nrep, enum mc_method method,
+			 unsigned long long seed, int nthreads, double *perr);
+
+#endif /* MONTE_CARLO_H */
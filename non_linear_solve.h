@@ -0,0 +1,100 @@
+/* Newton's and secant methods for non-linear equations,
+ * see non_linear_solve.c */
+
+#ifndef NON_LINEAR_SOLVE_H
+#define NON_LINEAR_SOLVE_H
+
+#include <math.h>
+#include "callback.h"
+#include "telemetry.h"
+
+#define NSOLVE_MAXREPT	1024
+
+/**
+ * nsolve_newton_ctx:
+ * @f : function, called as f(x, @ctx)
+ * @fprime : derivative of @f, called as fprime(x, @ctx)
+ * @ctx : passed to @f and @fprime
+ * @initv : initial value
+ * @epsilon : stop when two iterates differ by less than this
+ * @nr_iter : number of iterations done
+ *
+ * Newton's method, inlined at the call site so that @f and @fprime
+ * can be inlined into the iteration.
+ *
+ * Returns: Root of @f, NaN if not converged in NSOLVE_MAXREPT steps
+ */
+CB_INLINE double nsolve_newton_ctx(double (*f)(double, void *),
+				   double (*fprime)(double, void *),
+				   void *ctx, double initv,
+				   double epsilon, int *nr_iter)
+{
+	int i;
+	double res, prev = initv;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NSOLVE_NEWTON);
+	for (i = 0; i < NSOLVE_MAXREPT; i++) {
+		res = prev - f(prev, ctx) / fprime(prev, ctx);
+		telemetry_iter(&tm, fabs(res - prev));
+		if (fabs(res - prev) < epsilon) {
+			*nr_iter = i+1;
+			telemetry_evals(&tm, 2 * (i+1));
+			telemetry_end(&tm);
+			return res;
+		}
+		prev = res;
+	}
+	*nr_iter = NSOLVE_MAXREPT;
+	telemetry_evals(&tm, 2 * NSOLVE_MAXREPT);
+	telemetry_end(&tm);
+	return nan("no root");
+}
+
+/**
+ * nsolve_secant_ctx:
+ * @f : function, called as f(x, @ctx)
+ * @ctx : passed to @f
+ * @initv1 : first initial value
+ * @initv2 : second initial value
+ * @epsilon : stop when two iterates differ by less than this
+ * @nr_iter : number of iterations done
+ *
+ * Secant method, inlined at the call site like nsolve_newton_ctx().
+ *
+ * Returns: Root of @f, NaN if not converged in NSOLVE_MAXREPT steps
+ */
+CB_INLINE double nsolve_secant_ctx(double (*f)(double, void *), void *ctx,
+				   double initv1, double initv2,
+				   double epsilon, int *nr_iter)
+{
+	int i;
+	double res = initv2, prev = initv1, oldres;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NSOLVE_SECANT);
+	for (i = 0; i < NSOLVE_MAXREPT; i++) {
+		oldres = res;
+		res = res - f(res, ctx) * (res - prev)
+			    / (f(res, ctx) - f(prev, ctx));
+		telemetry_iter(&tm, fabs(oldres - res));
+		if (fabs(oldres - res) < epsilon) {
+			*nr_iter = i+1;
+			telemetry_evals(&tm, 3 * (i+1));
+			telemetry_end(&tm);
+			return res;
+		}
+		prev = oldres;
+	}
+	*nr_iter = NSOLVE_MAXREPT;
+	telemetry_evals(&tm, 3 * NSOLVE_MAXREPT);
+	telemetry_end(&tm);
+	return nan("no root");
+}
+
+double nsolve_newton(double (*f)(double), double (*fprime)(double),
+		     double initv, double epsilon, int *nr_iter);
+double nsolve_secant(double (*f)(double), double initv1,
+		     double initv2, double epsilon, int *nr_iter);
+
+#endif /* NON_LINEAR_SOLVE_H */
@@ -0,0 +1,23 @@
+/* All of the numerical library */
+
+#ifndef NUMERICAL_H
+#define NUMERICAL_H
+
+#include "vecmath.h"
+#include "callback.h"
+#include "workspace.h"
+#include "telemetry.h"
+#include "sink.h"
+#include "lineq_solver.h"
+#include "iterative.h"
+#include "non_linear_solve.h"
+#include "ode.h"
+#include "lagrange_interpolate.h"
+#include "psi.h"
+#include "numerical_integration.h"
+#include "romberg.h"
+#include "gauss_kronrod.h"
+#include "gauss_legendre.h"
+#include "monte_carlo.h"
+
+#endif /* NUMERICAL_H */
@@ -2,12 +2,38 @@
  * in both 1D and 2D
  */
 
-#include <stdio.h>
-#include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
+#include "numerical_integration.h"
 #undef NDEBUG
 #include <assert.h>
 
+/**
+ * generate_sample_vec:
+ * @fv: batched sampling function
+ * @data: passed to @fv
+ * @a: left boundary of sampling interval
+ * @h: step
+ * @n: number of partition intervals
+ * @v: array of f[(a, cutting points, b)]
+ *
+ * Sample a function on [a, a + n * h]
+ * at points x[i] = a + i * h, i = 0..n, in a single call of @fv.
+ *
+ * Modifies v.	No return value.
+ */
+void generate_sample_vec(vec_fn fv, void *data,
+			 double a, double h, int n, double v[n+1])
+{
+	int i;
+
+	/* with n >= 0 every abscissa is set before @fv reads it */
+	assert(v != NULL && n >= 0);
+	for (i = 0; i <= n; i++)
+		v[i] = a + h * i;
+	fv(n + 1, v, v, data);
+}
+
 /**
  * generate_sample:
  * @f: pointer to sampling function
@@ -24,71 +50,139 @@
 void generate_sample(double (*f)(double),
 		     double a, double h, int n, double v[n+1])
 {
-	int i;
+	generate_sample_vec(vec_scalar, &f, a, h, n, v);
+}
 
-	assert(v != NULL);
-	for (i = 0; i <= n; i++)
-		v[i] = f(a + h * i);
+/**
+ * nintegrate_1d_workspace:
+ * @n : number of partition intervals
+ *
+ * Returns: Bytes of workspace needed by nintegrate_trapezodial_vec_ws()
+ * and nintegrate_simpson_vec_ws() for @n intervals
+ */
+size_t nintegrate_1d_workspace(int n)
+{
+	return workspace_size(n + 1, sizeof(double));
 }
 
 /**
- * nintegrate_trapezodial:
- * @f : pointer to integrand
+ * nintegrate_trapezodial_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
  * @a : left boundary of integrating interval
  * @b : right boundary of integrating interval
  * @n : number of partition intervals
+ * @ws : workspace for the samples
  *
- * Performs numerical integration with
- * composite trapezodial algorithm.
+ * Same as nintegrate_trapezodial_vec() with the samples kept in @ws.
  *
- * Returns: Result of integration
+ * Returns: Result of integration, NaN if @ws is too small
  */
-double nintegrate_trapezodial(double (*f)(double),
-			      double a, double b, int n)
+double nintegrate_trapezodial_vec_ws(vec_fn fv, void *data,
+				     double a, double b, int n,
+				     struct workspace *ws)
 {
 	int i;
-	double *v = malloc((n+1) * sizeof(*v));
+	size_t mark = workspace_mark(ws);
+	double *v = workspace_alloc(ws, n + 1, sizeof(*v));
 	double sum = 0.0;
 	double h = (b - a) / n;
+	struct telemetry_call tm;
 
-	assert(f != NULL);
-	assert(v != NULL);
-	generate_sample(f, a, h, n, v);
+	assert(fv != NULL);
+	if (v == NULL)
+		return nan("workspace too small");
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_TRAPEZODIAL);
+	generate_sample_vec(fv, data, a, h, n, v);
 
 	for (i = 1; i < n; i++)
 		sum += v[i];
 	sum += v[0] / 2.0;
 	sum += v[n] / 2.0;
 
-	free(v);
+	telemetry_evals(&tm, n + 1);
+	telemetry_bytes(&tm, ws->used - mark);
+	workspace_release(ws, mark);
+	telemetry_end(&tm);
 
 	return sum * h;
 }
 
 /**
- * nintegrate_simpson:
+ * nintegrate_trapezodial_vec:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of partition intervals
+ *
+ * Performs numerical integration with
+ * composite trapezodial algorithm.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_trapezodial_vec(vec_fn fv, void *data,
+				  double a, double b, int n)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_1d_workspace(n)))
+		return nan("out of memory");
+	res = nintegrate_trapezodial_vec_ws(fv, data, a, b, n, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+/**
+ * nintegrate_trapezodial:
  * @f : pointer to integrand
  * @a : left boundary of integrating interval
  * @b : right boundary of integrating interval
- * @n : number of partiton intervals
+ * @n : number of partition intervals
  *
  * Performs numerical integration with
- * composite Simpson algorithm.
+ * composite trapezodial algorithm.
  *
  * Returns: Result of integration
  */
-double nintegrate_simpson(double (*f)(double),
-			  double a, double b, int n)
+double nintegrate_trapezodial(double (*f)(double),
+			      double a, double b, int n)
+{
+	assert(f != NULL);
+	return nintegrate_trapezodial_ctx(cb_scalar, &f, a, b, n);
+}
+
+/**
+ * nintegrate_simpson_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of partiton intervals
+ * @ws : workspace for the samples
+ *
+ * Same as nintegrate_simpson_vec() with the samples kept in @ws.
+ *
+ * Returns: Result of integration, NaN if @ws is too small
+ */
+double nintegrate_simpson_vec_ws(vec_fn fv, void *data,
+				 double a, double b, int n,
+				 struct workspace *ws)
 {
 	int i;
-	double *v = malloc((n+1) * sizeof(*v));
+	size_t mark = workspace_mark(ws);
+	double *v = workspace_alloc(ws, n + 1, sizeof(*v));
 	double sum_odd = 0.0, sum_even = 0.0;
 	double res;
 	double h = (b - a) / n;
+	struct telemetry_call tm;
 
-	assert(f != NULL);
-	assert(v != NULL);
-	generate_sample(f, a, h, n, v);
+	assert(fv != NULL);
+	if (v == NULL)
+		return nan("workspace too small");
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_SIMPSON);
+	generate_sample_vec(fv, data, a, h, n, v);
 
 	for (i = 1; i < n; i += 2)
 		sum_odd += v[i];
@@ -96,14 +190,63 @@ double nintegrate_simpson(double (*f)(double),
 		sum_even += v[i];
 	res = (v[0] + v[n] + 4.0*sum_odd + 2.0*sum_even) * h / 3.0;
 
-	free(v);
+	telemetry_evals(&tm, n + 1);
+	telemetry_bytes(&tm, ws->used - mark);
+	workspace_release(ws, mark);
+	telemetry_end(&tm);
 
 	return res;
 }
 
 /**
- * generate_sample_2d:
- * @f: pointer to sampling function
+ * nintegrate_simpson_vec:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of partiton intervals
+ *
+ * Performs numerical integration with
+ * composite Simpson algorithm.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_simpson_vec(vec_fn fv, void *data,
+			      double a, double b, int n)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_1d_workspace(n)))
+		return nan("out of memory");
+	res = nintegrate_simpson_vec_ws(fv, data, a, b, n, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+/**
+ * nintegrate_simpson:
+ * @f : pointer to integrand
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of partiton intervals
+ *
+ * Performs numerical integration with
+ * composite Simpson algorithm.
+ *
+ * Returns: Result of integration
+ */
+double nintegrate_simpson(double (*f)(double),
+			  double a, double b, int n)
+{
+	assert(f != NULL);
+	return nintegrate_simpson_ctx(cb_scalar, &f, a, b, n);
+}
+
+/**
+ * generate_sample_2d_vec:
+ * @fv: batched sampling function
+ * @data: passed to @fv
  * @a: left x boundary of sampling interval
  * @h: x step
  * @n: number of partition intervals in x direction
@@ -123,6 +266,43 @@ double nintegrate_simpson(double (*f)(double),
  *	[		]
  *	[		]
  *  x_n	[		]
+ * Each row is sampled in batches of VEC_CHUNK points.
+ *
+ * Modifies v.	No return value.
+ */
+void generate_sample_2d_vec(vec_fn_2d fv, void *data,
+			    double a, double h, int n,
+			    double b, double k, int m,
+			    double v[n+1][m+1])
+{
+	double xs[VEC_CHUNK], ys[VEC_CHUNK];
+	int i, j, j0, jn;
+
+	assert(v != NULL);
+	for (i = 0; i <= n; i++) {
+		for (j0 = 0; j0 <= m; j0 += VEC_CHUNK) {
+			jn = m + 1 - j0 < VEC_CHUNK ? m + 1 - j0 : VEC_CHUNK;
+			for (j = 0; j < jn; j++) {
+				xs[j] = a + h * i;
+				ys[j] = b + k * (j0 + j);
+			}
+			fv(jn, xs, ys, &v[i][j0], data);
+		}
+	}
+}
+
+/**
+ * generate_sample_2d:
+ * @f: pointer to sampling function
+ * @a: left x boundary of sampling interval
+ * @h: x step
+ * @n: number of partition intervals in x direction
+ * @b: left y boundary of sampling interval
+ * @k: y step
+ * @m: number of partition intervals in y direction
+ * @v: array of f[(a, cutting points, c), (b, cutting points, d)]
+ *
+ * Same as generate_sample_2d_vec() for a plain function.
  *
  * Modifies v.	No return value.
  */
@@ -131,12 +311,288 @@ void generate_sample_2d(double (*f)(double, double),
 			double b, double k, int m,
 			double v[n+1][m+1])
 {
-	int i, j;
+	generate_sample_2d_vec(vec_scalar_2d, &f, a, h, n, b, k, m, v);
+}
 
-	assert(v != NULL);
-	for (i = 0; i <= n; i++)
-		for (j = 0; j <= m; j++)
-			v[i][j] = f(a + h * i, b + k * j);
+/**
+ * generate_sample_2d_sink_vec:
+ * @fv: batched sampling function
+ * @data: passed to @fv
+ * @a: left x boundary of sampling interval
+ * @h: x step
+ * @n: number of partition intervals in x direction
+ * @b: left y boundary of sampling interval
+ * @k: y step
+ * @m: number of partition intervals in y direction
+ * @sink: receives the samples
+ *
+ * Same as generate_sample_2d_vec() with v[i] going to @sink as record
+ * i of m + 1 values.  @fv writes into the mapped file directly.
+ *
+ * Returns: 0 on success, -1 if samples were dropped
+ */
+int generate_sample_2d_sink_vec(vec_fn_2d fv, void *data,
+				double a, double h, int n,
+				double b, double k, int m,
+				struct sink *sink)
+{
+	double xs[VEC_CHUNK], ys[VEC_CHUNK], *v;
+	int i, j, j0, jn;
+
+	assert(sink != NULL);
+	if (sink_begin(sink, n + 1, m + 1, a, h, b, k))
+		return -1;
+	for (i = 0; i <= n; i++) {
+		for (j0 = 0; j0 <= m; j0 += VEC_CHUNK) {
+			jn = m + 1 - j0 < VEC_CHUNK ? m + 1 - j0 : VEC_CHUNK;
+			v = sink_claim(sink, jn);
+			if (v == NULL)
+				return -1;
+			for (j = 0; j < jn; j++) {
+				xs[j] = a + h * i;
+				ys[j] = b + k * (j0 + j);
+			}
+			fv(jn, xs, ys, v, data);
+		}
+	}
+	return sink_flush(sink);
+}
+
+/* Same as generate_sample_2d_sink_vec() for a plain function */
+int generate_sample_2d_sink(double (*f)(double, double),
+			    double a, double h, int n,
+			    double b, double k, int m,
+			    struct sink *sink)
+{
+	return generate_sample_2d_sink_vec(vec_scalar_2d, &f, a, h, n,
+					   b, k, m, sink);
+}
+
+/* weights of the composite rules at node i of 0..n, without the step */
+static double composite_weight(enum composite_rule rule, int i, int n)
+{
+	if (rule == NINTEGRATE_TRAPEZODIAL)
+		return (i == 0 || i == n) ? 0.5 : 1.0;
+	if (i == 0 || i == n)
+		return 1.0 / 3.0;
+	return (i % 2) ? 4.0 / 3.0 : 2.0 / 3.0;
+}
+
+/*
+ * The x nodes are cut into tiles of TILE_ROWS rows, each row into
+ * chunks of TILE_COLS samples so the sample buffer stays in L1.
+ * Tiles are dealt to threads round-robin and every tile keeps its own
+ * partial sum, which are added up in tile order at the end: the result
+ * does not depend on the number of threads.
+ */
+#define TILE_ROWS	16
+#define TILE_COLS	1024
+
+struct tile_job {
+	vec_fn_2d fv;
+	void *data;
+	double a, h;
+	int n;
+	double c, k;
+	int m;
+	enum composite_rule rule;
+	const double *wy;	/* y weights, m+1 entries */
+	double *partial;	/* one partial sum per tile */
+	int ntile;
+	int nthreads;
+	int id;
+};
+
+static void *tile_worker(void *p)
+{
+	struct tile_job *job = p;
+	double xs[TILE_COLS], ys[TILE_COLS], buf[TILE_COLS];
+	double wx, row, sum;
+	int t, i, j, j0, jn;
+
+	for (t = job->id; t < job->ntile; t += job->nthreads) {
+		sum = 0.0;
+		for (i = t * TILE_ROWS;
+		     i < (t + 1) * TILE_ROWS && i <= job->n; i++) {
+			wx = composite_weight(job->rule, i, job->n);
+			row = 0.0;
+			for (j0 = 0; j0 <= job->m; j0 += TILE_COLS) {
+				jn = job->m + 1 - j0;
+				if (jn > TILE_COLS)
+					jn = TILE_COLS;
+				for (j = 0; j < jn; j++) {
+					xs[j] = job->a + job->h * i;
+					ys[j] = job->c + job->k * (j0 + j);
+				}
+				job->fv(jn, xs, ys, buf, job->data);
+				for (j = 0; j < jn; j++)
+					row += job->wy[j0 + j] * buf[j];
+			}
+			sum += wx * row;
+		}
+		job->partial[t] = sum;
+	}
+	return NULL;
+}
+
+/**
+ * nintegrate_2d_workspace:
+ * @n : number of partition intervals in x direction
+ * @m : number of partition intervals in y direction
+ * @nthreads : number of threads sampling the integrand
+ *
+ * Returns: Bytes of workspace needed by nintegrate_2d_vec_ws()
+ */
+size_t nintegrate_2d_workspace(int n, int m, int nthreads)
+{
+	return workspace_size(m + 1, sizeof(double))
+	       + workspace_size(n / TILE_ROWS + 1, sizeof(double))
+	       + workspace_size(nthreads, sizeof(struct tile_job))
+	       + workspace_size(nthreads, sizeof(pthread_t));
+}
+
+/**
+ * nintegrate_2d_vec_ws:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left x boundary of integrating interval
+ * @b : right x boundary of integrating interval
+ * @n : number of partition intervals in x direction
+ * @c : left y boundary of integrating interval
+ * @d : right y boundary of integrating interval
+ * @m : number of partition intervals in y direction
+ * @rule : NINTEGRATE_TRAPEZODIAL or NINTEGRATE_SIMPSON
+ * @nthreads : number of threads sampling @f
+ * @ws : workspace for the weights, partial sums and thread handles
+ *
+ * Performs numerical integration with the composite rule applied in
+ * both directions.  The samples are weighted as they are produced, so
+ * no (n+1)*(m+1) grid is built; each thread only needs a row chunk,
+ * which is passed to @fv in one call.  @fv must be thread safe when
+ * @nthreads > 1; the threads are started for the call and joined
+ * before it returns, like those of the other threaded solvers.
+ *
+ * Returns: Result of integration, NaN if @ws is too small
+ */
+double nintegrate_2d_vec_ws(vec_fn_2d fv, void *data,
+			    double a, double b, int n,
+			    double c, double d, int m,
+			    enum composite_rule rule, int nthreads,
+			    struct workspace *ws)
+{
+	int ntile = n / TILE_ROWS + 1;
+	size_t mark = workspace_mark(ws);
+	double *wy = workspace_alloc(ws, m + 1, sizeof(*wy));
+	double *partial = workspace_alloc(ws, ntile, sizeof(*partial));
+	struct tile_job *jobs = workspace_alloc(ws, nthreads, sizeof(*jobs));
+	pthread_t *tids = workspace_alloc(ws, nthreads, sizeof(*tids));
+	double h = (b - a) / n, k = (d - c) / m;
+	double sum = NAN;
+	int i, j, nstarted;
+	struct telemetry_call tm;
+
+	assert(fv != NULL);
+	assert(n >= 1 && m >= 1 && nthreads >= 1);
+	if (wy == NULL || partial == NULL || jobs == NULL || tids == NULL)
+		goto out;
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_2D);
+
+	for (j = 0; j <= m; j++)
+		wy[j] = composite_weight(rule, j, m);
+	for (i = 0; i < nthreads; i++) {
+		jobs[i] = (struct tile_job) {
+			.fv = fv, .data = data,
+			.a = a, .h = h, .n = n,
+			.c = c, .k = k, .m = m,
+			.rule = rule, .wy = wy,
+			.partial = partial, .ntile = ntile,
+			.nthreads = nthreads, .id = i,
+		};
+	}
+
+	/* thread 0 is the caller; if a thread can't be started the
+	 * caller takes over its tiles */
+	for (nstarted = 1; nstarted < nthreads; nstarted++) {
+		if (pthread_create(&tids[nstarted], NULL, tile_worker,
+				   &jobs[nstarted]))
+			break;
+	}
+	tile_worker(&jobs[0]);
+	for (i = nstarted; i < nthreads; i++)
+		tile_worker(&jobs[i]);
+	for (i = 1; i < nstarted; i++)
+		pthread_join(tids[i], NULL);
+
+	sum = 0.0;
+	for (i = 0; i < ntile; i++)
+		sum += partial[i];
+	sum *= h * k;
+	telemetry_evals(&tm, (long) (n + 1) * (m + 1));
+	telemetry_bytes(&tm, ws->used - mark);
+	telemetry_end(&tm);
+
+out:
+	workspace_release(ws, mark);
+	return sum;
+}
+
+/**
+ * nintegrate_2d_vec:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left x boundary of integrating interval
+ * @b : right x boundary of integrating interval
+ * @n : number of partition intervals in x direction
+ * @c : left y boundary of integrating interval
+ * @d : right y boundary of integrating interval
+ * @m : number of partition intervals in y direction
+ * @rule : NINTEGRATE_TRAPEZODIAL or NINTEGRATE_SIMPSON
+ * @nthreads : number of threads sampling @f
+ *
+ * Same as nintegrate_2d_vec_ws() with a workspace of its own.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_2d_vec(vec_fn_2d fv, void *data,
+			 double a, double b, int n,
+			 double c, double d, int m,
+			 enum composite_rule rule, int nthreads)
+{
+	struct workspace ws;
+	double res;
+
+	if (workspace_init(&ws, nintegrate_2d_workspace(n, m, nthreads)))
+		return nan("out of memory");
+	res = nintegrate_2d_vec_ws(fv, data, a, b, n, c, d, m, rule,
+				   nthreads, &ws);
+	workspace_destroy(&ws);
+	return res;
+}
+
+/**
+ * nintegrate_2d:
+ * @f : pointer to integrand
+ * @a : left x boundary of integrating interval
+ * @b : right x boundary of integrating interval
+ * @n : number of partition intervals in x direction
+ * @c : left y boundary of integrating interval
+ * @d : right y boundary of integrating interval
+ * @m : number of partition intervals in y direction
+ * @rule : NINTEGRATE_TRAPEZODIAL or NINTEGRATE_SIMPSON
+ * @nthreads : number of threads sampling @f
+ *
+ * Same as nintegrate_2d_vec() for a plain function.
+ *
+ * Returns: Result of integration, NaN if out of memory
+ */
+double nintegrate_2d(double (*f)(double, double),
+		     double a, double b, int n,
+		     double c, double d, int m,
+		     enum composite_rule rule, int nthreads)
+{
+	assert(f != NULL);
+	return nintegrate_2d_vec(vec_scalar_2d, &f, a, b, n, c, d, m,
+				 rule, nthreads);
 }
 
 /**
@@ -150,7 +606,8 @@ void generate_sample_2d(double (*f)(double, double),
  * @m : number of partition intervals in y direction
  *
  * Performs numerical integration with
- * composite trapezodial algorithm.
+ * composite trapezodial algorithm in the calling thread; use
+ * nintegrate_2d() to sample @f from several threads.
  *
  * Returns: Result of integration
  */
@@ -158,46 +615,23 @@ double nintegrate_trapezodial_2d(double (*f)(double, double),
 				 double a, double b, int n,
 				 double c, double d, int m)
 {
-	int i, j;
-	double (*v)[m+1] = malloc((n+1) * (m+1) * sizeof(**v));
-	double sum = 0.0, bsum = 0.0;
-	double h = (b - a) / n, k = (d - c) / m;
-
-	assert(f != NULL);
-	assert(v != NULL);
-	generate_sample_2d(f, a, h, n, c, k, m, v);
-
-	/* interior */
-	for (i = 1; i < n; i++)
-		for (j = 1; j < m; j++)
-			sum += v[i][j];
-	/* boundary */
-	for (i = 1; i < n; i++)
-		bsum += v[i][0];
-	for (i = 1; i < n; i++)
-		bsum += v[i][m];
-	for (j = 1; j < m; j++)
-		bsum += v[0][j];
-	for (j = 1; j < m; j++)
-		bsum += v[n][j];
-	sum += 0.5 * bsum;
-	/* 4 vertexes */
-	sum += (v[0][0] + v[n][0] + v[0][m] + v[n][m]) * 0.25;
-
-	free(v);
-
-	return sum * h * k;
+	return nintegrate_2d(f, a, b, n, c, d, m,
+			     NINTEGRATE_TRAPEZODIAL, 1);
 }
 
 /**
  * nintegrate_simpson_2d:
- * @n : number of partiton intervals
  * @f : pointer to integrand
- * @a : left boundary of integrating interval
- * @b : right boundary of integrating interval
+ * @a : left x boundary of integrating interval
+ * @b : right x boundary of integrating interval
+ * @n : number of partition intervals in x direction
+ * @c : left y boundary of integrating interval
+ * @d : right y boundary of integrating interval
+ * @m : number of partition intervals in y direction
  *
  * Performs numerical integration with
- * composite Simpson algorithm.
+ * composite Simpson algorithm in the calling thread; use
+ * nintegrate_2d() to sample @f from several threads.
  *
  * Returns: Result of integration
  */
@@ -205,91 +639,6 @@ double nintegrate_simpson_2d(double (*f)(double, double),
 			     double a, double b, int n,
 			     double c, double d, int m)
 {
-	int i, j;
-	double (*v)[m+1] = malloc((n+1) * (m+1) * sizeof(**v));
-	double sum_odd_odd = 0.0, sum_odd_even = 0.0;
-	double sum_even_odd = 0.0, sum_even_even = 0.0;
-	double bsum_odd = 0.0, bsum_even = 0.0;
-	double res;
-	double h = (b - a) / n, k = (d - c) / m;
-
-	assert(f != NULL);
-	assert(v != NULL);
-	generate_sample_2d(f, a, h, n, c, k, m, v);
-
-	/* interior */
-	for (i = 1; i < n; i += 2) {
-		for (j = 1; j < m; j += 2)
-			sum_odd_odd += v[i][j];
-		for (j = 2; j < m; j += 2)
-			sum_odd_even += v[i][j];
-	}
-	for (i = 2; i < n; i += 2) {
-		for (j = 1; j < m; j += 2)
-			sum_even_odd += v[i][j];
-		for (j = 2; j < m; j += 2)
-			sum_even_even += v[i][j];
-	}
-
-	/* boundary */
-	for (i = 1; i < n; i += 2)
-		bsum_odd += v[i][0] + v[i][m];
-	for (i = 2; i < n; i += 2)
-		bsum_even += v[i][0] + v[i][m];
-	for (j = 1; j < m; j += 2)
-		bsum_odd += v[0][j] + v[n][j];
-	for (j = 2; j < m; j += 2)
-		bsum_even += v[0][j] + v[n][j];
-
-	res = (v[0][0] + v[0][m] + v[n][0] + v[n][m]
-	       + 16.0 * sum_odd_odd + 8.0 * sum_odd_even
-	       + 8.0 * sum_even_odd + 4.0 * sum_even_even
-	       + 4.0 * bsum_odd + 2.0 * bsum_even) * h * k / 9.0;
-
-	free(v);
-	return res;
-}
-
-double f(double x, double y)
-{
-	return 1.0 / (x + y);
-}
-
-int main(void)
-{
-	int i;
-	double true_value;
-	double nres;
-
-	true_value = cos(1.0) - cos(5.0);
-	printf("Composite trapezoidal integration:\n");
-	for (i = 1; i <= 1 << 12; i *= 2) {
-		nres = nintegrate_trapezodial(sin, 1.0, 5.0, i);
-		printf("n = %d, result = %.13f, error = %.13f\n",
-		       i, nres, fabs(nres - true_value));
-	}
-
-	printf("\nComposite Simpson integration:\n");
-	for (i = 2; i <= 1 << 12; i *= 2) {
-		nres = nintegrate_simpson(sin, 1.0, 5.0, i);
-		printf("n = %d, result = %.13f, error = %.13f\n",
-		       i, nres, fabs(nres - true_value));
-	}
-
-	printf("\n2D Composite trapezodial integration:\n");
-	true_value = 2.911031660324;
-	for (i = 1; i <= 1 << 12; i *= 2) {
-		nres = nintegrate_trapezodial_2d(f, 1, 5, i, 1, 5, i);
-		printf("n = %d, result = %.13f, error = %.13f\n",
-		       i, nres, fabs(nres - true_value));
-	}
-
-	printf("\n2D Composite Simpson integration:\n");
-	for (i = 1; i <= 1 << 12; i *= 2) {
-		nres = nintegrate_simpson_2d(f, 1, 5, i, 1, 5, i);
-		printf("n = %d, result = %.13f, error = %.13f\n",
-		       i, nres, fabs(nres - true_value));
-	}
-
-	return 0;
+	return nintegrate_2d(f, a, b, n, c, d, m,
+			     NINTEGRATE_SIMPSON, 1);
 }
@@ -0,0 +1,144 @@
+/* Composite trapezoidal and Simpson rules in 1D and 2D,
+ * see numerical_integration.c */
+
+#ifndef NUMERICAL_INTEGRATION_H
+#define NUMERICAL_INTEGRATION_H
+
+#include "vecmath.h"
+#include "callback.h"
+#include "workspace.h"
+#include "telemetry.h"
+#include "sink.h"
+
+enum composite_rule {
+	NINTEGRATE_TRAPEZODIAL,
+	NINTEGRATE_SIMPSON,
+};
+
+/**
+ * nintegrate_trapezodial_ctx:
+ * @f : integrand, called as f(x, @ctx)
+ * @ctx : passed to @f
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of partition intervals
+ *
+ * Performs numerical integration with composite trapezodial
+ * algorithm, inlined at the call site so that @f can be inlined into
+ * the summation.  Samples at the same points and sums in the same
+ * order as nintegrate_trapezodial_vec().
+ *
+ * Returns: Result of integration
+ */
+CB_INLINE double nintegrate_trapezodial_ctx(double (*f)(double, void *),
+					    void *ctx, double a, double b,
+					    int n)
+{
+	int i;
+	double sum = 0.0;
+	double h = (b - a) / n;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_TRAPEZODIAL);
+	for (i = 1; i < n; i++)
+		sum += f(a + h * i, ctx);
+	sum += f(a, ctx) / 2.0;
+	sum += f(a + h * n, ctx) / 2.0;
+	telemetry_evals(&tm, n + 1);
+	telemetry_end(&tm);
+
+	return sum * h;
+}
+
+/**
+ * nintegrate_simpson_ctx:
+ * @f : integrand, called as f(x, @ctx)
+ * @ctx : passed to @f
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @n : number of partiton intervals
+ *
+ * Performs numerical integration with composite Simpson algorithm,
+ * inlined at the call site like nintegrate_trapezodial_ctx().
+ *
+ * Returns: Result of integration
+ */
+CB_INLINE double nintegrate_simpson_ctx(double (*f)(double, void *),
+					void *ctx, double a, double b, int n)
+{
+	int i;
+	double sum_odd = 0.0, sum_even = 0.0, res;
+	double h = (b - a) / n;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_SIMPSON);
+	for (i = 1; i < n; i += 2)
+		sum_odd += f(a + h * i, ctx);
+	for (i = 2; i < n; i += 2)
+		sum_even += f(a + h * i, ctx);
+	res = (f(a, ctx) + f(a + h * n, ctx)
+	       + 4.0*sum_odd + 2.0*sum_even) * h / 3.0;
+	telemetry_evals(&tm, n + 1);
+	telemetry_end(&tm);
+
+	return res;
+}
+
+void generate_sample_vec(vec_fn fv, void *data,
+			 double a, double h, int n, double v[n+1]);
+void generate_sample(double (*f)(double),
+		     double a, double h, int n, double v[n+1]);
+size_t nintegrate_1d_workspace(int n);
+double nintegrate_trapezodial_vec_ws(vec_fn fv, void *data,
+				     double a, double b, int n,
+				     struct workspace *ws);
+double nintegrate_trapezodial_vec(vec_fn fv, void *data,
+				  double a, double b, int n);
+double nintegrate_trapezodial(double (*f)(double),
+			      double a, double b, int n);
+double nintegrate_simpson_vec_ws(vec_fn fv, void *data,
+				 double a, double b, int n,
+				 struct workspace *ws);
+double nintegrate_simpson_vec(vec_fn fv, void *data,
+			      double a, double b, int n);
+double nintegrate_simpson(double (*f)(double),
+			  double a, double b, int n);
+
+void generate_sample_2d_vec(vec_fn_2d fv, void *data,
+			    double a, double h, int n,
+			    double b, double k, int m,
+			    double v[n+1][m+1]);
+void generate_sample_2d(double (*f)(double, double),
+			double a, double h, int n,
+			double b, double k, int m,
+			double v[n+1][m+1]);
+int generate_sample_2d_sink_vec(vec_fn_2d fv, void *data,
+				double a, double h, int n,
+				double b, double k, int m,
+				struct sink *sink);
+int generate_sample_2d_sink(double (*f)(double, double),
+			    double a, double h, int n,
+			    double b, double k, int m,
+			    struct sink *sink);
+size_t nintegrate_2d_workspace(int n, int m, int nthreads);
+double nintegrate_2d_vec_ws(vec_fn_2d fv, void *data,
+			    double a, double b, int n,
+			    double c, double d, int m,
+			    enum composite_rule rule, int nthreads,
+			    struct workspace *ws);
+double nintegrate_2d_vec(vec_fn_2d fv, void *data,
+			 double a, double b, int n,
+			 double c, double d, int m,
+			 enum composite_rule rule, int nthreads);
+double nintegrate_2d(double (*f)(double, double),
+		     double a, double b, int n,
+		     double c, double d, int m,
+		     enum composite_rule rule, int nthreads);
+double nintegrate_trapezodial_2d(double (*f)(double, double),
+				 double a, double b, int n,
+				 double c, double d, int m);
+double nintegrate_simpson_2d(double (*f)(double, double),
+			     double a, double b, int n,
+			     double c, double d, int m);
+
+#endif /* NUMERICAL_INTEGRATION_H */
@@ -0,0 +1,193 @@
+/* Runge-Kutta and Adams methods for y' = f(x, y), see ode.c */
+
+#ifndef ODE_H
+#define ODE_H
+
+#include "callback.h"
+#include "telemetry.h"
+#include "sink.h"
+
+/*
+ * the stepping loop of ndsolve_runge_ctx(), also starts the Adams
+ * method; appends y after every step to @sink unless it is NULL
+ */
+CB_INLINE double ndsolve_runge_steps(double (*f)(double, double, void *),
+				     void *ctx, double a, double b,
+				     double h, double initv,
+				     struct sink *sink,
+				     struct telemetry_call *tm)
+{
+	int i, n = (b - a) / h;
+	double k1, k2, k3, k4;
+	double x, y = initv;
+
+	for (i = 0; i < n; i++) {
+		x = a + i * h;
+		k1 = f(x, y, ctx);
+		k2 = f(x + h / 2, y + h * k1 / 2, ctx);
+		k3 = f(x + h / 2, y + h * k2 / 2, ctx);
+		k4 = f(x + h, y + h * k3, ctx);
+		y += (k1 + 2*k2 + 2*k3 + k4) * h / 6;
+		if (sink != NULL)
+			sink_put(sink, y);
+	}
+	telemetry_evals(tm, 4 * (n > 0 ? n : 0));
+	telemetry_iters(tm, n > 0 ? n : 0);
+
+	return y;
+}
+
+/**
+ * ndsolve_runge_sink_ctx:
+ * @f : right-hand side, called as f(x, y, @ctx)
+ * @ctx : passed to @f
+ * @a : initial point
+ * @b : end point
+ * @h : step
+ * @initv : y(@a)
+ * @sink : receives the trajectory, or NULL
+ *
+ * Classical fourth order Runge-Kutta method, inlined at the call site
+ * so that @f can be inlined into the stepping loop.  The trajectory
+ * y(@a + i * @h), i = 0..n goes to @sink as n + 1 records of one value.
+ *
+ * Returns: y(@b)
+ */
+CB_INLINE double ndsolve_runge_sink_ctx(double (*f)(double, double, void *),
+					void *ctx, double a, double b,
+					double h, double initv,
+					struct sink *sink)
+{
+	struct telemetry_call tm;
+	int n = (b - a) / h;
+	double y;
+
+	telemetry_begin(&tm, TELEMETRY_NDSOLVE_RUNGE);
+	if (sink != NULL) {
+		sink_begin(sink, n > 0 ? n + 1 : 1, 1, a, h, 0, 0);
+		sink_put(sink, initv);
+	}
+	y = ndsolve_runge_steps(f, ctx, a, b, h, initv, sink, &tm);
+	if (sink != NULL)
+		sink_flush(sink);
+	telemetry_end(&tm);
+
+	return y;
+}
+
+/**
+ * ndsolve_runge_ctx:
+ * @f : right-hand side, called as f(x, y, @ctx)
+ * @ctx : passed to @f
+ * @a : initial point
+ * @b : end point
+ * @h : step
+ * @initv : y(@a)
+ *
+ * Same as ndsolve_runge_sink_ctx() without keeping the trajectory.
+ *
+ * Returns: y(@b)
+ */
+CB_INLINE double ndsolve_runge_ctx(double (*f)(double, double, void *),
+				   void *ctx, double a, double b,
+				   double h, double initv)
+{
+	return ndsolve_runge_sink_ctx(f, ctx, a, b, h, initv, NULL);
+}
+
+/**
+ * ndsolve_adams_sink_ctx:
+ * @f : right-hand side, called as f(x, y, @ctx)
+ * @ctx : passed to @f
+ * @a : initial point
+ * @b : end point
+ * @h : step
+ * @initv : y(@a)
+ * @sink : receives the trajectory, or NULL
+ *
+ * Third order Adams predictor-corrector method started with
+ * Runge-Kutta, inlined at the call site like ndsolve_runge_ctx().  The
+ * trajectory goes to @sink as for ndsolve_runge_sink_ctx().
+ *
+ * Returns: y(@b)
+ */
+CB_INLINE double ndsolve_adams_sink_ctx(double (*f)(double, double, void *),
+					void *ctx, double a, double b,
+					double h, double initv,
+					struct sink *sink)
+{
+	int i, n = (b - a) / h;
+	double xnp1, xn, xnm1, xnm2;
+	double ynp1, yn, ynm1, ynm2;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_NDSOLVE_ADAMS);
+	ynm2 = initv;
+	ynm1 = ndsolve_runge_steps(f, ctx, a, a + h, h, initv, NULL, &tm);
+	yn = ndsolve_runge_steps(f, ctx, a, a + 2 * h, h, initv, NULL, &tm);
+	/* the start-up values that lie within [a, b] */
+	if (sink != NULL) {
+		sink_begin(sink, n > 0 ? n + 1 : 1, 1, a, h, 0, 0);
+		sink_put(sink, ynm2);
+		if (n >= 1)
+			sink_put(sink, ynm1);
+		if (n >= 2)
+			sink_put(sink, yn);
+	}
+	for (i = 0; i < n-2; i++) {
+		xnp1 = a + (i + 3) * h;
+		xn = a + (i + 2) * h;
+		xnm1 = a + (i + 1) * h;
+		xnm2 = a + i * h;
+		ynp1 = yn + (23 * f(xn, yn, ctx) - 16 * f(xnm1, ynm1, ctx)
+			     + 5 * f(xnm2, ynm2, ctx)) * h / 12;
+		ynp1 = yn + (5 * f(xnp1, ynp1, ctx) + 8 * f(xn, yn, ctx)
+			     - f(xnm1, ynm1, ctx)) * h / 12;
+		ynm2 = ynm1;
+		ynm1 = yn;
+		yn = ynp1;
+		if (sink != NULL)
+			sink_put(sink, ynp1);
+	}
+	if (sink != NULL)
+		sink_flush(sink);
+	telemetry_evals(&tm, 6 * (n > 2 ? n - 2 : 0));
+	telemetry_iters(&tm, n > 2 ? n - 2 : 0);
+	telemetry_end(&tm);
+	if (n < 2)
+		return n == 1 ? ynm1 : ynm2;
+	return yn;
+}
+
+/**
+ * ndsolve_adams_ctx:
+ * @f : right-hand side, called as f(x, y, @ctx)
+ * @ctx : passed to @f
+ * @a : initial point
+ * @b : end point
+ * @h : step
+ * @initv : y(@a)
+ *
+ * Same as ndsolve_adams_sink_ctx() without keeping the trajectory.
+ *
+ * Returns: y(@b)
+ */
+CB_INLINE double ndsolve_adams_ctx(double (*f)(double, double, void *),
+				   void *ctx, double a, double b,
+				   double h, double initv)
+{
+	return ndsolve_adams_sink_ctx(f, ctx, a, b, h, initv, NULL);
+}
+
+double ndsolve_runge(double (*f)(double, double), double a,
+		     double b, double h, double initv);
+double ndsolve_adams(double (*f)(double, double), double a,
+		     double b, double h, double initv);
+double ndsolve_runge_sink(double (*f)(double, double), double a,
+			  double b, double h, double initv,
+			  struct sink *sink);
+double ndsolve_adams_sink(double (*f)(double, double), double a,
+			  double b, double h, double initv,
+			  struct sink *sink);
+
+#endif /* ODE_H */
@@ -0,0 +1,144 @@
+/* Numerical Methods, Lab Exercise 01
+ * PB09203226 */
+
+#include <math.h>
+#include <pthread.h>
+#include "psi.h"
+#include "telemetry.h"
+
+/* calculates $\Psi(x) = \sum^\infty_{n=1} \frac{1}{n(n+x)}$, x > -1
+ * returns result
+ * The first N-1 terms are summed directly, the tail with the
+ * Euler-Maclaurin formula for $g(t) = \frac{1}{t(t+x)}$: $$
+ * \sum^\infty_{n=N} g(n) = \int^\infty_N g(t) dt + \frac{g(N)}{2}
+ *    + \sum^K_{k=1} \frac{B_{2k}}{2k} D_{2k}, \quad
+ * D_j = \frac{1}{x} \left( N^{-j} - (N+x)^{-j} \right)
+ *    = \frac{D_{j-1} + (N+x)^{-j}}{N}
+ * $$
+ * where $\int^\infty_N g = \frac{1}{x} \ln(1 + \frac{x}{N})$.
+ * With N = 16 and K = 8 the remainder is below $10^{-20}$ for x >= 0.
+ */
+#define PSI_N		16
+#define PSI_K		8
+static const long double psi_bern[PSI_K] = {	/* B_{2k} / 2k */
+	1.0L / 12, -1.0L / 120, 1.0L / 252, -1.0L / 240,
+	1.0L / 132, -691.0L / 32760, 1.0L / 12, -3617.0L / 8160,
+};
+
+long double get_psi(double x)
+{
+	int n, k;
+	long double sum = 0.0, t, d = 0.0, b, bj;
+
+	for (n = 1; n < PSI_N; n++)
+		sum += 1.0L / (n * (n + (long double) x));
+
+	b = 1.0L / (PSI_N + (long double) x);
+	t = x / (long double) PSI_N;
+	sum += (t == 0.0 ? 1.0L : log1pl(t) / t) / PSI_N;
+	sum += b / PSI_N / 2.0L;
+	bj = b;
+	for (k = 0; k < PSI_K; k++) {
+		d = (d + bj) / PSI_N;
+		bj *= b;
+		d = (d + bj) / PSI_N;
+		bj *= b;
+		sum += psi_bern[k] * d;
+	}
+
+	return sum;
+}
+
+/*
+ * Batch version in double.  The loops run across a chunk of x values
+ * so that every step of the formula above vectorizes; chunks are split
+ * between threads.
+ */
+#define PSI_CHUNK	256
+
+static void psi_chunk(int n, const double x[], double res[])
+{
+	double sum[PSI_CHUNK], d[PSI_CHUNK], b[PSI_CHUNK], bj[PSI_CHUNK];
+	double t;
+	int i, j, k;
+
+	for (i = 0; i < n; i++)
+		sum[i] = 0.0;
+	for (j = 1; j < PSI_N; j++)
+		for (i = 0; i < n; i++)
+			sum[i] += 1.0 / (j * (j + x[i]));
+	for (i = 0; i < n; i++) {
+		t = x[i] / PSI_N;
+		sum[i] += (t == 0.0 ? 1.0 : log1p(t) / t) / PSI_N;
+	}
+	for (i = 0; i < n; i++) {
+		b[i] = 1.0 / (PSI_N + x[i]);
+		sum[i] += b[i] / PSI_N / 2.0;
+		bj[i] = b[i];
+		d[i] = 0.0;
+	}
+	for (k = 0; k < PSI_K; k++) {
+		for (i = 0; i < n; i++) {
+			d[i] = (d[i] + bj[i]) / PSI_N;
+			bj[i] *= b[i];
+			d[i] = (d[i] + bj[i]) / PSI_N;
+			bj[i] *= b[i];
+			sum[i] += (double) psi_bern[k] * d[i];
+		}
+	}
+	for (i = 0; i < n; i++)
+		res[i] = sum[i];
+}
+
+struct psi_job {
+	int n;
+	const double *x;
+	double *res;
+};
+
+static void *psi_worker(void *p)
+{
+	struct psi_job *job = p;
+	int i;
+
+	for (i = 0; i < job->n; i += PSI_CHUNK)
+		psi_chunk(job->n - i < PSI_CHUNK ? job->n - i : PSI_CHUNK,
+			  job->x + i, job->res + i);
+	return NULL;
+}
+
+/* calculates res[i] = Psi(x[i]) for i = 0..n-1 in double precision
+ * using up to nthreads threads, each on a contiguous range of x
+ */
+void get_psi_batch(int n, const double x[], double res[], int nthreads)
+{
+	if (nthreads < 1)
+		nthreads = 1;
+
+	struct psi_job jobs[nthreads];
+	pthread_t tids[nthreads];
+	int i, len = (n + nthreads - 1) / nthreads, nstarted;
+	struct telemetry_call tm;
+
+	telemetry_begin(&tm, TELEMETRY_PSI_BATCH);
+	for (i = 0; i < nthreads; i++) {
+		jobs[i].x = x + i * len;
+		jobs[i].res = res + i * len;
+		jobs[i].n = n - i * len < len ? n - i * len : len;
+		if (jobs[i].n < 0)
+			jobs[i].n = 0;
+	}
+	/* the caller runs job 0 and any job whose thread failed to start */
+	for (nstarted = 1; nstarted < nthreads; nstarted++) {
+		if (pthread_create(&tids[nstarted], NULL, psi_worker,
+				   &jobs[nstarted]))
+			break;
+	}
+	psi_worker(&jobs[0]);
+	for (i = nstarted; i < nthreads; i++)
+		psi_worker(&jobs[i]);
+	for (i = 1; i < nstarted; i++)
+		pthread_join(tids[i], NULL);
+	telemetry_evals(&tm, n);
+	telemetry_end(&tm);
+}
@@ -0,0 +1,9 @@
+/* Series $\Psi(x) = \sum^\infty_{n=1} \frac{1}{n(n+x)}$, see psi.c */
+
+#ifndef PSI_H
+#define PSI_H
+
+long double get_psi(double x);
+void get_psi_batch(int n, const double x[], double res[], int nthreads);
+
+#endif /* PSI_H */
@@ -0,0 +1,131 @@
+/* Implements incremental Romberg integration
+ *
+ * Each refinement halves the step of the composite trapezoidal rule,
+ * evaluating the integrand only at the new midpoints, and extends the
+ * Richardson extrapolation tableau by one row.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#undef NDEBUG
+#include <assert.h>
+#include "romberg.h"
+#include "telemetry.h"
+
+#define ROMBERG_MINLEVEL	3
+
+/**
+ * nintegrate_romberg_vec:
+ * @fv : batched integrand
+ * @data : passed to @fv
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @epsilon : requested absolute error
+ * @maxlevel : maximal number of step halvings, at most ROMBERG_MAXLEVEL
+ * @perr : error estimate of the result, may be NULL
+ * @pneval : number of evaluations of @fv, may be NULL
+ *
+ * Performs Romberg integration.  Level k of the tableau is built from
+ * the trapezoidal sum with 2^k intervals, which reuses every sample of
+ * level k-1 and adds 2^(k-1) new midpoints, so reaching level k costs
+ * 2^k + 1 evaluations in total.  Only the last row of the tableau is
+ * kept.  The new midpoints are passed to @fv VEC_CHUNK at a time.
+ * Iteration stops when the last two entries of the newest row
+ * differ by less than @epsilon, but not before level ROMBERG_MINLEVEL.
+ *
+ * If @maxlevel is reached first, the last diagonal entry is returned
+ * and *@perr tells how far it is from convergence.
+ *
+ * Returns: Result of integration
+ */
+double nintegrate_romberg_vec(vec_fn fv, void *data, double a, double b,
+			      double epsilon, int maxlevel,
+			      double *perr, int *pneval)
+{
+	double row[ROMBERG_MAXLEVEL+1];
+	double v[VEC_CHUNK];
+	double h = b - a;
+	double trap, sum, prev, cur, factor, err = INFINITY;
+	long i, i0, nnew = 1;
+	int j, k, nv, neval;
+	struct telemetry_call tm;
+
+	assert(fv != NULL);
+	assert(maxlevel >= 1 && maxlevel <= ROMBERG_MAXLEVEL);
+	telemetry_begin(&tm, TELEMETRY_NINTEGRATE_ROMBERG);
+
+	v[0] = a;
+	v[1] = b;
+	fv(2, v, v, data);
+	trap = (v[0] + v[1]) * h / 2.0;
+	neval = 2;
+	row[0] = trap;
+
+	for (k = 1; k <= maxlevel; k++) {
+		h /= 2.0;
+		sum = 0.0;
+		for (i0 = 0; i0 < nnew; i0 += VEC_CHUNK) {
+			nv = nnew - i0 < VEC_CHUNK ? nnew - i0 : VEC_CHUNK;
+			for (i = 0; i < nv; i++)
+				v[i] = a + (2 * (i0 + i) + 1) * h;
+			fv(nv, v, v, data);
+			for (i = 0; i < nv; i++)
+				sum += v[i];
+		}
+		neval += nnew;
+		nnew *= 2;
+		trap = trap / 2.0 + sum * h;
+
+		/* extend the tableau in place: row[j] holds R(k-1, j)
+		 * until it is overwritten with R(k, j) */
+		prev = row[0];
+		row[0] = trap;
+		factor = 1.0;
+		for (j = 1; j <= k; j++) {
+			factor *= 4.0;
+			cur = row[j-1] + (row[j-1] - prev) / (factor - 1.0);
+			if (j < k)
+				prev = row[j];
+			row[j] = cur;
+		}
+
+		err = fabs(row[k] - row[k-1]);
+		telemetry_iter(&tm, err);
+		if (k >= ROMBERG_MINLEVEL && err < epsilon)
+			break;
+	}
+	if (k > maxlevel)
+		k = maxlevel;
+
+	if (perr != NULL)
+		*perr = err;
+	if (pneval != NULL)
+		*pneval = neval;
+	telemetry_evals(&tm, neval);
+	telemetry_end(&tm);
+
+	return row[k];
+}
+
+/**
+ * nintegrate_romberg:
+ * @f : pointer to integrand
+ * @a : left boundary of integrating interval
+ * @b : right boundary of integrating interval
+ * @epsilon : requested absolute error
+ * @maxlevel : maximal number of step halvings, at most ROMBERG_MAXLEVEL
+ * @perr : error estimate of the result, may be NULL
+ * @pneval : number of evaluations of @f, may be NULL
+ *
+ * Same as nintegrate_romberg_vec() for a plain function.
+ *
+ * Returns: Result of integration
+ */
+double nintegrate_romberg(double (*f)(double), double a, double b,
+			  double epsilon, int maxlevel,
+			  double *perr, int *pneval)
+{
+	assert(f != NULL);
+	return nintegrate_romberg_vec(vec_scalar, &f, a, b, epsilon,
+				      maxlevel, perr, pneval);
+}
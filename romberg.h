@@ -0,0 +1,17 @@
+/* Incremental Romberg integration, see romberg.c */
+
+#ifndef ROMBERG_H
+#define ROMBERG_H
+
+#include "vecmath.h"
+
+#define ROMBERG_MAXLEVEL	30
+
+double nintegrate_romberg_vec(vec_fn fv, void *data, double a, double b,
+			      double epsilon, int maxlevel,
+			      double *perr, int *pneval);
+double nintegrate_romberg(double (*f)(double), double a, double b,
+			  double epsilon, int maxlevel,
+			  double *perr, int *pneval);
+
+#endif /* ROMBERG_H */
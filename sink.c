@@ -0,0 +1,333 @@
+/* Writes trajectories and sample grids to a memory-mapped file
+ *
+ * A sink is one file holding one data set: a struct sink_header and
+ * then fixed-size records of doubles, laid out so that the file can be
+ * used as an array in place.  Solvers with a _sink variant call
+ * sink_begin() with the shape of their output and then fill the
+ * records in through sink_claim(), which hands out room inside a
+ * SINK_WINDOW sized mapping of the file; the file is grown and the
+ * window moved on a chunk at a time.  Every time the window moves and
+ * at sink_flush(), the number of complete records is published in the
+ * header, so another process can map the file with sink_view_open()
+ * and read the records while the solver is still running.
+ *
+ * Typical use:
+ *
+ *	sink_open(&s, "trajectory.sink");
+ *	ndsolve_runge_sink(f, a, b, h, initv, &s);
+ *	if (sink_close(&s))
+ *		... some records were lost ...
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#undef NDEBUG
+#include <assert.h>
+#include "sink.h"
+
+/* records complete so far, for readers */
+static void sink_publish(struct sink *s)
+{
+	if (s->hdr->ncols > 0)
+		__atomic_store_n(&s->hdr->nrecords,
+				 s->nvalues / s->hdr->ncols, __ATOMIC_RELEASE);
+}
+
+static void sink_unmap_window(struct sink *s)
+{
+	if (s->win_len > 0)
+		munmap(s->win, s->win_len);
+	s->win = NULL;
+	s->win_off = s->pos;
+	s->win_len = 0;
+}
+
+/**
+ * sink_open:
+ * @s : sink to initialize
+ * @path : file to write, truncated if it exists
+ *
+ * Creates the file with an empty header; the solver writing into @s
+ * fills the header in.
+ *
+ * Returns: 0 on success, -1 with errno set on failure
+ */
+int sink_open(struct sink *s, const char *path)
+{
+	int saved;
+
+	assert(s != NULL && path != NULL);
+	memset(s, 0, sizeof(*s));
+	s->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (s->fd < 0)
+		return -1;
+	if (ftruncate(s->fd, SINK_DATA_OFFSET))
+		goto fail;
+	s->hdr = mmap(NULL, SINK_DATA_OFFSET, PROT_READ | PROT_WRITE,
+		      MAP_SHARED, s->fd, 0);
+	if (s->hdr == MAP_FAILED)
+		goto fail;
+	memcpy(s->hdr->magic, SINK_MAGIC, sizeof(SINK_MAGIC));
+	s->hdr->version = SINK_VERSION;
+	s->hdr->dtype = SINK_F64;
+	s->pos = SINK_DATA_OFFSET;
+	s->win_off = s->pos;
+	return 0;
+
+fail:
+	saved = errno;
+	close(s->fd);
+	errno = saved;
+	return -1;
+}
+
+/**
+ * sink_begin:
+ * @s : sink
+ * @nrows : number of records to come
+ * @ncols : values per record
+ * @x0 : abscissa of the first record
+ * @dx : abscissa step between records
+ * @y0 : ordinate of the first value of a record
+ * @dy : ordinate step between values
+ *
+ * Starts a new data set in @s, dropping what was written before.
+ * Called by the solvers.
+ *
+ * Returns: 0 on success, -1 with errno set on failure
+ */
+int sink_begin(struct sink *s, uint64_t nrows, uint64_t ncols,
+	       double x0, double dx, double y0, double dy)
+{
+	assert(ncols >= 1);
+	s->pos = SINK_DATA_OFFSET;
+	sink_unmap_window(s);
+	s->nvalues = 0;
+	s->err = 0;
+	__atomic_store_n(&s->hdr->nrecords, 0, __ATOMIC_RELEASE);
+	s->hdr->nrows = nrows;
+	s->hdr->ncols = ncols;
+	s->hdr->origin[0] = x0;
+	s->hdr->origin[1] = y0;
+	s->hdr->step[0] = dx;
+	s->hdr->step[1] = dy;
+	if (ftruncate(s->fd, SINK_DATA_OFFSET)) {
+		s->err = errno;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * sink_claim_slow:
+ * @s : sink
+ * @n : number of values
+ *
+ * Moves the window of @s on to the current position, growing the file
+ * to cover it, then hands out the room like sink_claim().  Publishes
+ * the records written so far.
+ *
+ * Returns: The room, NULL if the file could not be grown or mapped
+ */
+double *sink_claim_slow(struct sink *s, size_t n)
+{
+	long page = sysconf(_SC_PAGESIZE);
+	off_t off;
+	void *win;
+	int err;
+
+	assert(n * sizeof(double) <= SINK_WINDOW / 2);
+	if (s->err)
+		return NULL;
+	sink_publish(s);
+	sink_unmap_window(s);
+
+	off = s->pos / page * page;
+	err = posix_fallocate(s->fd, off, SINK_WINDOW);
+	if (err) {
+		s->err = err;
+		return NULL;
+	}
+	win = mmap(NULL, SINK_WINDOW, PROT_READ | PROT_WRITE, MAP_SHARED,
+		   s->fd, off);
+	if (win == MAP_FAILED) {
+		s->err = errno;
+		return NULL;
+	}
+	s->win = win;
+	s->win_off = off;
+	s->win_len = SINK_WINDOW;
+	return sink_claim(s, n);
+}
+
+/**
+ * sink_write:
+ * @s : sink
+ * @v : values
+ * @n : number of values
+ *
+ * Appends @n values, which need not make up whole records.
+ *
+ * Returns: 0 on success, -1 if the values were dropped
+ */
+int sink_write(struct sink *s, const double *v, size_t n)
+{
+	size_t m, max = SINK_WINDOW / 2 / sizeof(*v);
+	double *p;
+
+	for (; n > 0; n -= m, v += m) {
+		m = n < max ? n : max;
+		p = sink_claim(s, m);
+		if (p == NULL)
+			return -1;
+		memcpy(p, v, m * sizeof(*v));
+	}
+	return 0;
+}
+
+/**
+ * sink_flush:
+ * @s : sink
+ *
+ * Publishes the records complete so far to readers.
+ *
+ * Returns: 0, -1 if values have been dropped since sink_begin()
+ */
+int sink_flush(struct sink *s)
+{
+	sink_publish(s);
+	return s->err ? -1 : 0;
+}
+
+/**
+ * sink_close:
+ * @s : sink
+ *
+ * Publishes the records, cuts the file down to them and closes it.
+ *
+ * Returns: 0 on success, -1 if values have been dropped or the file
+ * could not be finished
+ */
+int sink_close(struct sink *s)
+{
+	int ret = s->err ? -1 : 0;
+
+	sink_publish(s);
+	sink_unmap_window(s);
+	if (ftruncate(s->fd, SINK_DATA_OFFSET
+			     + s->nvalues * sizeof(double)))
+		ret = -1;
+	munmap(s->hdr, SINK_DATA_OFFSET);
+	if (close(s->fd))
+		ret = -1;
+	s->hdr = NULL;
+	s->fd = -1;
+	return ret;
+}
+
+/* maps all of the file as it is now */
+static int sink_view_map(struct sink_view *v)
+{
+	struct stat st;
+	char *map;
+
+	if (fstat(v->fd, &st))
+		return -1;
+	if (st.st_size < SINK_DATA_OFFSET) {
+		errno = EINVAL;
+		return -1;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, v->fd, 0);
+	if (map == MAP_FAILED)
+		return -1;
+	if (v->map != NULL)
+		munmap(v->map, v->len);
+	v->map = map;
+	v->len = st.st_size;
+	v->hdr = (const struct sink_header *) map;
+	v->data = (const double *) (map + SINK_DATA_OFFSET);
+	return 0;
+}
+
+/**
+ * sink_view_open:
+ * @v : view to initialize
+ * @path : file written by a sink, possibly still being written
+ *
+ * Maps the file read-only.  v->hdr and v->data point into the mapping;
+ * they change when sink_view_records() has to map the file again.
+ *
+ * Returns: 0 on success, -1 with errno set on failure
+ */
+int sink_view_open(struct sink_view *v, const char *path)
+{
+	int saved;
+
+	assert(v != NULL && path != NULL);
+	memset(v, 0, sizeof(*v));
+	v->fd = open(path, O_RDONLY);
+	if (v->fd < 0)
+		return -1;
+	if (sink_view_map(v))
+		goto fail;
+	if (memcmp(v->hdr->magic, SINK_MAGIC, sizeof(SINK_MAGIC))
+	    || v->hdr->version != SINK_VERSION
+	    || v->hdr->dtype != SINK_F64) {
+		errno = EINVAL;
+		goto fail;
+	}
+	return 0;
+
+fail:
+	saved = errno;
+	if (v->map != NULL)
+		munmap(v->map, v->len);
+	close(v->fd);
+	errno = saved;
+	return -1;
+}
+
+/**
+ * sink_view_records:
+ * @v : view
+ *
+ * Maps the file again if the writer has published records beyond the
+ * current mapping.
+ *
+ * Returns: Number of complete records readable at v->data
+ */
+uint64_t sink_view_records(struct sink_view *v)
+{
+	uint64_t n = __atomic_load_n(&v->hdr->nrecords, __ATOMIC_ACQUIRE);
+	uint64_t row = v->hdr->ncols * sizeof(double);
+	uint64_t max;
+
+	if (row == 0)
+		return 0;
+	if (SINK_DATA_OFFSET + n * row > v->len)
+		sink_view_map(v);
+	max = (v->len - SINK_DATA_OFFSET) / row;
+	return n < max ? n : max;
+}
+
+/**
+ * sink_view_close:
+ * @v : view
+ *
+ * Unmaps and closes the file.
+ *
+ * No return value.
+ */
+void sink_view_close(struct sink_view *v)
+{
+	munmap(v->map, v->len);
+	close(v->fd);
+	v->map = NULL;
+	v->hdr = NULL;
+	v->data = NULL;
+}
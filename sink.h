@@ -0,0 +1,106 @@
+/* Binary output of trajectories and sample grids, see sink.c */
+
+#ifndef SINK_H
+#define SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define SINK_MAGIC	"NUMSINK"
+#define SINK_VERSION	1
+/* the header takes the first page, the values follow */
+#define SINK_DATA_OFFSET	4096
+/* bytes of the file mapped at a time for writing */
+#define SINK_WINDOW	(16 << 20)
+
+enum sink_dtype {
+	SINK_F64 = 1,		/* double, native byte order */
+};
+
+/*
+ * File layout: this header at offset 0, then nrows records of ncols
+ * values each from SINK_DATA_OFFSET on, row after row.  Value j of
+ * record i is the sample at (origin[0] + i * step[0],
+ * origin[1] + j * step[1]).  nrecords counts the records written so far
+ * and is updated while the solver runs; a reader that loads it with
+ * acquire semantics may read that many records.
+ */
+struct sink_header {
+	char magic[8];		/* SINK_MAGIC */
+	uint32_t version;	/* SINK_VERSION */
+	uint32_t dtype;		/* enum sink_dtype */
+	uint64_t nrows;		/* records the solver will write */
+	uint64_t ncols;		/* values per record */
+	double origin[2];
+	double step[2];
+	uint64_t nrecords;	/* records complete */
+};
+
+/* writing end, owned by one thread */
+struct sink {
+	int fd;
+	int err;		/* a write failed, later writes are dropped */
+	struct sink_header *hdr;
+	char *win;		/* mapped part of the file */
+	off_t win_off;		/* file offset of win */
+	size_t win_len;
+	off_t pos;		/* file offset of the next value */
+	uint64_t nvalues;	/* values handed out since sink_begin() */
+};
+
+/* reading end, see sink_view_records() */
+struct sink_view {
+	int fd;
+	char *map;
+	size_t len;
+	const struct sink_header *hdr;
+	const double *data;
+};
+
+int sink_open(struct sink *s, const char *path);
+int sink_begin(struct sink *s, uint64_t nrows, uint64_t ncols,
+	       double x0, double dx, double y0, double dy);
+double *sink_claim_slow(struct sink *s, size_t n);
+int sink_write(struct sink *s, const double *v, size_t n);
+int sink_flush(struct sink *s);
+int sink_close(struct sink *s);
+
+int sink_view_open(struct sink_view *v, const char *path);
+uint64_t sink_view_records(struct sink_view *v);
+void sink_view_close(struct sink_view *v);
+
+/**
+ * sink_claim:
+ * @s : sink
+ * @n : number of values, at most SINK_WINDOW / 2 bytes worth
+ *
+ * Hands out room for the next @n values inside the mapped file, for
+ * the caller to fill in before the next call on @s.  Solvers write
+ * their results straight into the file this way.
+ *
+ * Returns: The room, NULL if the file could not be grown or mapped
+ */
+static inline double *sink_claim(struct sink *s, size_t n)
+{
+	double *p;
+
+	if (s->pos + (off_t) (n * sizeof(*p)) > s->win_off
+						  + (off_t) s->win_len)
+		return sink_claim_slow(s, n);
+	p = (double *) (s->win + (s->pos - s->win_off));
+	s->pos += n * sizeof(*p);
+	s->nvalues += n;
+	return p;
+}
+
+/* appends one value */
+static inline void sink_put(struct sink *s, double v)
+{
+	double *p = sink_claim(s, 1);
+
+	if (p != NULL)
+		*p = v;
+}
+
+#endif /* SINK_H */
@@ -0,0 +1,437 @@
+/* Implements collection and export of the solver metrics
+ *
+ * Every thread that calls a solver gets a block of per-solver stats on
+ * its first call and is the only writer of it, so recording a call
+ * takes no lock and no atomic read-modify-write.  Each block carries a
+ * sequence count that is odd while its owner updates it; a snapshot
+ * copies each block until it reads the same even count before and
+ * after.  When a thread exits, its block is folded into the stats of
+ * the exited threads.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#undef NDEBUG
+#include <assert.h>
+#include "telemetry.h"
+
+static const char *const telemetry_names[TELEMETRY_NSOLVERS] = {
+	[TELEMETRY_LSOLVE_COLMAJ] = "lsolve_colmaj",
+	[TELEMETRY_LSOLVE_SOR] = "lsolve_sor",
+	[TELEMETRY_NSOLVE_NEWTON] = "nsolve_newton",
+	[TELEMETRY_NSOLVE_SECANT] = "nsolve_secant",
+	[TELEMETRY_NDSOLVE_RUNGE] = "ndsolve_runge",
+	[TELEMETRY_NDSOLVE_ADAMS] = "ndsolve_adams",
+	[TELEMETRY_LAGRANGE_MAX_ERROR] = "get_max_error",
+	[TELEMETRY_PSI_BATCH] = "get_psi_batch",
+	[TELEMETRY_NINTEGRATE_TRAPEZODIAL] = "nintegrate_trapezodial",
+	[TELEMETRY_NINTEGRATE_SIMPSON] = "nintegrate_simpson",
+	[TELEMETRY_NINTEGRATE_2D] = "nintegrate_2d",
+	[TELEMETRY_NINTEGRATE_ROMBERG] = "nintegrate_romberg",
+	[TELEMETRY_NINTEGRATE_GK] = "nintegrate_gk",
+	[TELEMETRY_NINTEGRATE_GL] = "nintegrate_gl",
+	[TELEMETRY_NINTEGRATE_MC] = "nintegrate_mc",
+};
+
+const char *telemetry_name(enum telemetry_solver solver)
+{
+	assert(solver >= 0 && solver < TELEMETRY_NSOLVERS);
+	return telemetry_names[solver];
+}
+
+/* upper bounds of the histogram buckets, the last one is +Inf */
+static double bucket_bound_seconds(int k)
+{
+	return ldexp(1e-9, k + 4);
+}
+
+static double bucket_bound_evals(int k)
+{
+	return ldexp(1.0, k);
+}
+
+static double bucket_bound_residual(int k)
+{
+	return pow(10.0, k - 24);
+}
+
+#ifdef NUMERICAL_TELEMETRY
+
+static void stats_add(struct telemetry_stats *dst,
+		      const struct telemetry_stats *src)
+{
+	int k;
+
+	dst->calls += src->calls;
+	dst->evals += src->evals;
+	dst->iters += src->iters;
+	dst->bytes += src->bytes;
+	dst->nsec += src->nsec;
+	dst->nresidual += src->nresidual;
+	dst->nonfinite += src->nonfinite;
+	dst->residual_sum += src->residual_sum;
+	for (k = 0; k < TELEMETRY_NBUCKETS; k++) {
+		dst->time_hist[k] += src->time_hist[k];
+		dst->evals_hist[k] += src->evals_hist[k];
+		dst->residual_hist[k] += src->residual_hist[k];
+	}
+	if (src->last_end > dst->last_end) {
+		dst->last_end = src->last_end;
+		dst->nhistory = src->nhistory;
+		memcpy(dst->history, src->history, sizeof(dst->history));
+	}
+}
+
+static void stats_add_all(struct telemetry_snapshot *dst,
+			  const struct telemetry_snapshot *src)
+{
+	int i;
+
+	for (i = 0; i < TELEMETRY_NSOLVERS; i++)
+		stats_add(&dst->solver[i], &src->solver[i]);
+}
+
+struct telemetry_block {
+	unsigned seq;
+	struct telemetry_snapshot stats;
+	struct telemetry_block *prev, *next;
+};
+
+static pthread_mutex_t telemetry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t telemetry_once = PTHREAD_ONCE_INIT;
+static pthread_key_t telemetry_key;
+static struct telemetry_block *telemetry_threads;
+static struct telemetry_snapshot telemetry_exited;
+static __thread struct telemetry_block *telemetry_self;
+
+static void telemetry_thread_exit(void *p)
+{
+	struct telemetry_block *b = p;
+
+	pthread_mutex_lock(&telemetry_lock);
+	stats_add_all(&telemetry_exited, &b->stats);
+	if (b->prev != NULL)
+		b->prev->next = b->next;
+	else
+		telemetry_threads = b->next;
+	if (b->next != NULL)
+		b->next->prev = b->prev;
+	pthread_mutex_unlock(&telemetry_lock);
+	free(b);
+}
+
+static void telemetry_init(void)
+{
+	pthread_key_create(&telemetry_key, telemetry_thread_exit);
+}
+
+/* the calling thread's block, NULL if it can't be allocated */
+static struct telemetry_block *telemetry_block(void)
+{
+	struct telemetry_block *b = telemetry_self;
+
+	if (b != NULL)
+		return b;
+	pthread_once(&telemetry_once, telemetry_init);
+	b = calloc(1, sizeof(*b));
+	if (b == NULL)
+		return NULL;
+	pthread_mutex_lock(&telemetry_lock);
+	b->next = telemetry_threads;
+	if (b->next != NULL)
+		b->next->prev = b;
+	telemetry_threads = b;
+	pthread_mutex_unlock(&telemetry_lock);
+	pthread_setspecific(telemetry_key, b);
+	telemetry_self = b;
+	return b;
+}
+
+static unsigned long long telemetry_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* first bucket whose bound is at least @v */
+static int bucket_log2(unsigned long long v, int shift)
+{
+	int k = 0;
+
+	while (k < TELEMETRY_NBUCKETS - 1 && v > 1ULL << (k + shift))
+		k++;
+	return k;
+}
+
+static int bucket_residual(double r)
+{
+	int k = 0;
+
+	if (!(r == r))
+		return TELEMETRY_NBUCKETS - 1;
+	while (k < TELEMETRY_NBUCKETS - 1 && r > bucket_bound_residual(k))
+		k++;
+	return k;
+}
+
+/**
+ * telemetry_begin:
+ * @call : the call to record
+ * @solver : which solver is called
+ *
+ * Starts recording a solver call.
+ *
+ * No return value.
+ */
+void telemetry_begin(struct telemetry_call *call,
+		     enum telemetry_solver solver)
+{
+	call->solver = solver;
+	call->evals = 0;
+	call->iters = 0;
+	call->bytes = 0;
+	call->has_residual = 0;
+	call->residual = 0.0;
+	call->nhistory = 0;
+	call->start = telemetry_now();
+}
+
+/**
+ * telemetry_end:
+ * @call : the call started by telemetry_begin()
+ *
+ * Adds the call to the stats of the calling thread.  Drops it if the
+ * thread's block could not be allocated.
+ *
+ * No return value.
+ */
+void telemetry_end(struct telemetry_call *call)
+{
+	unsigned long long end = telemetry_now();
+	struct telemetry_block *b = telemetry_block();
+	struct telemetry_stats *s;
+
+	if (b == NULL)
+		return;
+	s = &b->stats.solver[call->solver];
+
+	__atomic_store_n(&b->seq, b->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	s->calls++;
+	s->evals += call->evals;
+	s->iters += call->iters;
+	s->bytes += call->bytes;
+	s->nsec += end - call->start;
+	s->time_hist[bucket_log2(end - call->start, 4)]++;
+	s->evals_hist[bucket_log2(call->evals, 0)]++;
+	if (call->has_residual) {
+		s->nresidual++;
+		/* one NaN or infinity would poison the sum for good */
+		if (isfinite(call->residual))
+			s->residual_sum += call->residual;
+		else
+			s->nonfinite++;
+		s->residual_hist[bucket_residual(call->residual)]++;
+	}
+	s->last_end = end;
+	s->nhistory = call->nhistory;
+	memcpy(s->history, call->history, s->nhistory * sizeof(double));
+
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&b->seq, b->seq + 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * telemetry_snapshot:
+ * @snap : where to store the stats
+ *
+ * Adds up the stats of all threads, running and exited, since the
+ * start of the program.  Calls still running are not included.
+ *
+ * Modifies snap.  No return value.
+ */
+void telemetry_snapshot(struct telemetry_snapshot *snap)
+{
+	static struct telemetry_snapshot copy;	/* under telemetry_lock */
+	struct telemetry_block *b;
+	unsigned seq;
+
+	pthread_mutex_lock(&telemetry_lock);
+	*snap = telemetry_exited;
+	for (b = telemetry_threads; b != NULL; b = b->next) {
+		do {
+			seq = __atomic_load_n(&b->seq, __ATOMIC_ACQUIRE);
+			memcpy(&copy, &b->stats, sizeof(copy));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		} while ((seq & 1)
+			 || seq != __atomic_load_n(&b->seq, __ATOMIC_RELAXED));
+		stats_add_all(snap, &copy);
+	}
+	pthread_mutex_unlock(&telemetry_lock);
+}
+
+#else
+
+void telemetry_snapshot(struct telemetry_snapshot *snap)
+{
+	memset(snap, 0, sizeof(*snap));
+}
+
+#endif /* NUMERICAL_TELEMETRY */
+
+static void write_json_hist(FILE *out, const char *key,
+			    const unsigned long hist[])
+{
+	int k;
+
+	fprintf(out, ", \"%s\": [", key);
+	for (k = 0; k < TELEMETRY_NBUCKETS; k++)
+		fprintf(out, "%s%lu", k ? ", " : "", hist[k]);
+	fprintf(out, "]");
+}
+
+/**
+ * telemetry_write_json:
+ * @out : output stream
+ * @snap : stats from telemetry_snapshot()
+ *
+ * Writes one JSON object with a member per solver that has been
+ * called, holding the totals (seconds, evals, iterations, bytes), the
+ * histograms as arrays of TELEMETRY_NBUCKETS counts (see telemetry.h
+ * for the bounds), the number of NaN or infinite residuals and the
+ * residuals of the latest call.
+ *
+ * Returns: 0, or -1 on output error
+ */
+int telemetry_write_json(FILE *out, const struct telemetry_snapshot *snap)
+{
+	const struct telemetry_stats *s;
+	int i, k, first = 1;
+
+	fprintf(out, "{");
+	for (i = 0; i < TELEMETRY_NSOLVERS; i++) {
+		s = &snap->solver[i];
+		if (s->calls == 0)
+			continue;
+		fprintf(out, "%s\n  \"%s\": {\"calls\": %lu, \"seconds\": %.9g, "
+			"\"evals\": %lu, \"iterations\": %lu, \"bytes\": %lu",
+			first ? "" : ",", telemetry_names[i], s->calls,
+			s->nsec * 1e-9, s->evals, s->iters, s->bytes);
+		write_json_hist(out, "time_hist", s->time_hist);
+		write_json_hist(out, "evals_hist", s->evals_hist);
+		write_json_hist(out, "residual_hist", s->residual_hist);
+		fprintf(out, ", \"nonfinite_residuals\": %lu", s->nonfinite);
+		fprintf(out, ", \"last_residuals\": [");
+		for (k = 0; k < s->nhistory; k++)
+			fprintf(out, "%s%.6g", k ? ", " : "", s->history[k]);
+		fprintf(out, "]}");
+		first = 0;
+	}
+	fprintf(out, "\n}\n");
+	return ferror(out) ? -1 : 0;
+}
+
+static void write_prom_counter(FILE *out, const char *name,
+			       const char *help,
+			       const struct telemetry_snapshot *snap,
+			       size_t offset)
+{
+	int i;
+
+	fprintf(out, "# HELP numerical_%s %s\n", name, help);
+	fprintf(out, "# TYPE numerical_%s counter\n", name);
+	for (i = 0; i < TELEMETRY_NSOLVERS; i++) {
+		if (snap->solver[i].calls == 0)
+			continue;
+		fprintf(out, "numerical_%s{solver=\"%s\"} %lu\n", name,
+			telemetry_names[i],
+			*(const unsigned long *)
+			((const char *) &snap->solver[i] + offset));
+	}
+}
+
+static void write_prom_hist(FILE *out, const char *name, const char *help,
+			    const struct telemetry_snapshot *snap,
+			    size_t offset, double (*bound)(int))
+{
+	const struct telemetry_stats *s;
+	const unsigned long *hist;
+	unsigned long cum, count;
+	double sum;
+	int i, k;
+
+	fprintf(out, "# HELP numerical_%s %s\n", name, help);
+	fprintf(out, "# TYPE numerical_%s histogram\n", name);
+	for (i = 0; i < TELEMETRY_NSOLVERS; i++) {
+		s = &snap->solver[i];
+		hist = (const unsigned long *) ((const char *) s + offset);
+		if (hist == s->residual_hist) {
+			count = s->nresidual;
+			sum = s->residual_sum;
+		} else {
+			count = s->calls;
+			sum = hist == s->time_hist ? s->nsec * 1e-9 : s->evals;
+		}
+		if (count == 0)
+			continue;
+		cum = 0;
+		for (k = 0; k < TELEMETRY_NBUCKETS - 1; k++) {
+			cum += hist[k];
+			fprintf(out, "numerical_%s_bucket{solver=\"%s\","
+				"le=\"%.6g\"} %lu\n", name, telemetry_names[i],
+				bound(k), cum);
+		}
+		fprintf(out, "numerical_%s_bucket{solver=\"%s\",le=\"+Inf\"} "
+			"%lu\n", name, telemetry_names[i], count);
+		fprintf(out, "numerical_%s_sum{solver=\"%s\"} %.9g\n",
+			name, telemetry_names[i], sum);
+		fprintf(out, "numerical_%s_count{solver=\"%s\"} %lu\n",
+			name, telemetry_names[i], count);
+	}
+}
+
+/**
+ * telemetry_write_prometheus:
+ * @out : output stream
+ * @snap : stats from telemetry_snapshot()
+ *
+ * Writes the stats in the Prometheus text exposition format, labelled
+ * by solver: counters for calls, evaluations, iterations, bytes and
+ * non-finite residuals, histograms of wall time, evaluations and
+ * residual per call.  The residual sum leaves non-finite ones out.
+ *
+ * Returns: 0, or -1 on output error
+ */
+int telemetry_write_prometheus(FILE *out,
+			       const struct telemetry_snapshot *snap)
+{
+	write_prom_counter(out, "calls_total", "Solver calls.", snap,
+			   offsetof(struct telemetry_stats, calls));
+	write_prom_counter(out, "evals_total", "Function evaluations.", snap,
+			   offsetof(struct telemetry_stats, evals));
+	write_prom_counter(out, "iterations_total", "Solver iterations.",
+			   snap, offsetof(struct telemetry_stats, iters));
+	write_prom_counter(out, "bytes_total", "Workspace bytes used.", snap,
+			   offsetof(struct telemetry_stats, bytes));
+	write_prom_counter(out, "residual_nonfinite_total",
+			   "Calls ending with a NaN or infinite residual.",
+			   snap, offsetof(struct telemetry_stats, nonfinite));
+	write_prom_hist(out, "call_seconds", "Wall time per call.", snap,
+			offsetof(struct telemetry_stats, time_hist),
+			bucket_bound_seconds);
+	write_prom_hist(out, "call_evals", "Function evaluations per call.",
+			snap, offsetof(struct telemetry_stats, evals_hist),
+			bucket_bound_evals);
+	write_prom_hist(out, "call_residual",
+			"Final residual or error estimate per call, "
+			"the sum over finite ones only.", snap,
+			offsetof(struct telemetry_stats, residual_hist),
+			bucket_bound_residual);
+	return ferror(out) ? -1 : 0;
+}
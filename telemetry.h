@@ -0,0 +1,168 @@
+/* Per-call solver metrics, see telemetry.c
+ *
+ * Built with -DNUMERICAL_TELEMETRY (make TELEMETRY=1), every solver
+ * call records its wall time, function evaluations, iterations,
+ * workspace bytes and final residual into a block owned by the calling
+ * thread; telemetry_snapshot() adds the blocks of all threads up.
+ * Without it the hooks below are empty and compile away, and snapshots
+ * are all zero.  Code calling the static inline _ctx solvers directly
+ * has to be built with the same setting as the library.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+enum telemetry_solver {
+	TELEMETRY_LSOLVE_COLMAJ,
+	TELEMETRY_LSOLVE_SOR,
+	TELEMETRY_NSOLVE_NEWTON,
+	TELEMETRY_NSOLVE_SECANT,
+	TELEMETRY_NDSOLVE_RUNGE,
+	TELEMETRY_NDSOLVE_ADAMS,
+	TELEMETRY_LAGRANGE_MAX_ERROR,
+	TELEMETRY_PSI_BATCH,
+	TELEMETRY_NINTEGRATE_TRAPEZODIAL,
+	TELEMETRY_NINTEGRATE_SIMPSON,
+	TELEMETRY_NINTEGRATE_2D,
+	TELEMETRY_NINTEGRATE_ROMBERG,
+	TELEMETRY_NINTEGRATE_GK,
+	TELEMETRY_NINTEGRATE_GL,
+	TELEMETRY_NINTEGRATE_MC,
+	TELEMETRY_NSOLVERS,
+};
+
+/*
+ * Histogram bucket k < TELEMETRY_NBUCKETS - 1 counts the values up to
+ * its bound, the last bucket everything above:
+ *   wall time	2^(k+4) ns, 16 ns .. 34 s
+ *   evaluations	2^k
+ *   residual	10^(k-24)
+ */
+#define TELEMETRY_NBUCKETS	32
+/* residuals of the latest call kept for inspection */
+#define TELEMETRY_HISTORY	32
+
+struct telemetry_stats {
+	unsigned long calls;
+	unsigned long evals;
+	unsigned long iters;
+	unsigned long bytes;
+	unsigned long nsec;
+	unsigned long nresidual;	/* calls that reported a residual */
+	unsigned long nonfinite;	/* of those, NaN or infinite ones */
+	double residual_sum;		/* of the finite residuals */
+	unsigned long time_hist[TELEMETRY_NBUCKETS];
+	unsigned long evals_hist[TELEMETRY_NBUCKETS];
+	unsigned long residual_hist[TELEMETRY_NBUCKETS];
+	/* residuals of the first iterations of the latest call */
+	unsigned long long last_end;	/* ns, orders calls across threads */
+	int nhistory;
+	double history[TELEMETRY_HISTORY];
+};
+
+struct telemetry_snapshot {
+	struct telemetry_stats solver[TELEMETRY_NSOLVERS];
+};
+
+const char *telemetry_name(enum telemetry_solver solver);
+void telemetry_snapshot(struct telemetry_snapshot *snap);
+int telemetry_write_json(FILE *out, const struct telemetry_snapshot *snap);
+int telemetry_write_prometheus(FILE *out,
+			       const struct telemetry_snapshot *snap);
+
+#ifdef NUMERICAL_TELEMETRY
+
+/* one solver call in progress, lives on the solver's stack */
+struct telemetry_call {
+	enum telemetry_solver solver;
+	unsigned long long start;
+	long evals;
+	long iters;
+	size_t bytes;
+	int has_residual;
+	double residual;
+	int nhistory;
+	double history[TELEMETRY_HISTORY];
+};
+
+void telemetry_begin(struct telemetry_call *call,
+		     enum telemetry_solver solver);
+void telemetry_end(struct telemetry_call *call);
+
+static inline void telemetry_evals(struct telemetry_call *call, long n)
+{
+	call->evals += n;
+}
+
+/* one more iteration, ending with @residual */
+static inline void telemetry_iter(struct telemetry_call *call,
+				  double residual)
+{
+	if (call->nhistory < TELEMETRY_HISTORY)
+		call->history[call->nhistory++] = residual;
+	call->iters++;
+	call->has_residual = 1;
+	call->residual = residual;
+}
+
+/* @n more iterations or steps without a residual */
+static inline void telemetry_iters(struct telemetry_call *call, long n)
+{
+	call->iters += n;
+}
+
+/* final residual or error estimate of a non-iterative call */
+static inline void telemetry_residual(struct telemetry_call *call,
+				      double residual)
+{
+	call->has_residual = 1;
+	call->residual = residual;
+}
+
+static inline void telemetry_bytes(struct telemetry_call *call, size_t n)
+{
+	call->bytes += n;
+}
+
+#else
+
+struct telemetry_call {
+};
+
+static inline void telemetry_begin(struct telemetry_call *call,
+				   enum telemetry_solver solver)
+{
+}
+
+static inline void telemetry_end(struct telemetry_call *call)
+{
+}
+
+static inline void telemetry_evals(struct telemetry_call *call, long n)
+{
+}
+
+static inline void telemetry_iter(struct telemetry_call *call,
+				  double residual)
+{
+}
+
+static inline void telemetry_iters(struct telemetry_call *call, long n)
+{
+}
+
+static inline void telemetry_residual(struct telemetry_call *call,
+				      double residual)
+{
+}
+
+static inline void telemetry_bytes(struct telemetry_call *call, size_t n)
+{
+}
+
+#endif /* NUMERICAL_TELEMETRY */
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,232 @@
+/* Batched integrands and vectorizable elementary functions
+ *
+ * A batched integrand fills y[i] = f(x[i]) for a whole array of
+ * abscissae in one call, so the indirect call is paid once per batch
+ * and the loop inside can be inlined and vectorized.  The kernels
+ * below are written as straight-line loops without calls so the
+ * compiler can vectorize them; arguments outside their reduction range
+ * fall back to libm.
+ */
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <math.h>
+
+/*
+ * vec_fn: y[i] = f(x[i]) for i = 0..n-1, @y may be the same array as @x
+ * vec_fn_2d: z[i] = f(x[i], y[i]) for i = 0..n-1
+ * vec_fn_3d: v[i] = f(x[i], y[i], z[i]) for i = 0..n-1
+ * vec_fn_nd: y[i] = f(x[i*dim], ..., x[i*dim + dim-1]) for i = 0..n-1
+ * @data is passed through untouched from the caller of the integrator.
+ */
+typedef void (*vec_fn)(int n, const double x[], double y[], void *data);
+typedef void (*vec_fn_2d)(int n, const double x[], const double y[],
+			  double z[], void *data);
+typedef void (*vec_fn_3d)(int n, const double x[], const double y[],
+			  const double z[], double v[], void *data);
+typedef void (*vec_fn_nd)(int n, int dim, const double x[], double y[],
+			  void *data);
+
+/* batch size used by integrators that build abscissae on the stack */
+#define VEC_CHUNK	256
+
+/*
+ * Adapters for plain function pointers: pass vec_scalar as the batched
+ * integrand and the address of the function pointer as @data.
+ */
+static inline void vec_scalar(int n, const double x[], double y[],
+			      void *data)
+{
+	double (*f)(double) = *(double (**)(double)) data;
+	int i;
+
+	for (i = 0; i < n; i++)
+		y[i] = f(x[i]);
+}
+
+static inline void vec_scalar_2d(int n, const double x[], const double y[],
+				 double z[], void *data)
+{
+	double (*f)(double, double) = *(double (**)(double, double)) data;
+	int i;
+
+	for (i = 0; i < n; i++)
+		z[i] = f(x[i], y[i]);
+}
+
+static inline void vec_scalar_3d(int n, const double x[], const double y[],
+				 const double z[], double v[], void *data)
+{
+	double (*f)(double, double, double) =
+		*(double (**)(double, double, double)) data;
+	int i;
+
+	for (i = 0; i < n; i++)
+		v[i] = f(x[i], y[i], z[i]);
+}
+
+/* pi/2 in three parts of 33 bits each, k * part is exact for small k */
+#define VEC_PIO2_1	1.57079632673412561417e+00
+#define VEC_PIO2_2	6.07710050630396597660e-11
+#define VEC_PIO2_3	2.02226624871116645580e-21
+#define VEC_TRIG_MAX	1e5
+/* adding and subtracting this rounds to an integer */
+#define VEC_ROUND	6755399441055744.0	/* 1.5 * 2^52 */
+
+/* minimax polynomials on [-pi/4, pi/4], from fdlibm */
+static inline double vec_sin_kernel(double r)
+{
+	double z = r * r;
+
+	return r + r * z * (-1.66666666666666324348e-01 + z *
+		(8.33333333332248946124e-03 + z *
+		(-1.98412698298579493134e-04 + z *
+		(2.75573137070700676789e-06 + z *
+		(-2.50507602534068634195e-08 + z *
+		1.58969099521155010221e-10)))));
+}
+
+static inline double vec_cos_kernel(double r)
+{
+	double z = r * r;
+
+	return 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z *
+		(-1.38888888888741095749e-03 + z *
+		(2.48015872894767294178e-05 + z *
+		(-2.75573143513906633035e-07 + z *
+		(2.08757232129817482790e-09 + z *
+		-1.13596475577881948265e-11)))));
+}
+
+/*
+ * Reduces x to r in [-pi/4, pi/4] with x = q * pi/2 + r and returns
+ * the quadrant q mod 4 as a double, keeping everything in floating
+ * point so the loops vectorize.
+ */
+static inline double vec_trig_reduce(double x, double *r)
+{
+	double k = (x * 0.63661977236758134308 + VEC_ROUND) - VEC_ROUND;
+	double q = k - 4.0 * ((k * 0.25 + VEC_ROUND) - VEC_ROUND);
+
+	*r = ((x - k * VEC_PIO2_1) - k * VEC_PIO2_2) - k * VEC_PIO2_3;
+	return q < 0.0 ? q + 4.0 : q;
+}
+
+static inline double vec_sin1(double x)
+{
+	double r, q, s, c;
+
+	q = vec_trig_reduce(x, &r);
+	s = vec_sin_kernel(r);
+	c = vec_cos_kernel(r);
+	s = (q == 1.0 || q == 3.0) ? c : s;
+	return (q >= 2.0) ? -s : s;
+}
+
+static inline double vec_cos1(double x)
+{
+	double r, q, s, c;
+
+	q = vec_trig_reduce(x, &r);
+	s = vec_sin_kernel(r);
+	c = vec_cos_kernel(r);
+	c = (q == 1.0 || q == 3.0) ? s : c;
+	return (q == 1.0 || q == 2.0) ? -c : c;
+}
+
+#define VEC_LN2_HI	6.93147180369123816490e-01
+#define VEC_LN2_LO	1.90821492927058770002e-10
+#define VEC_EXP_MAX	708.0
+
+/* degree 13 Taylor polynomial on [-ln2/2, ln2/2] */
+static inline double vec_exp1(double x)
+{
+	union { double d; long long i; } scale;
+	double k, r, p;
+
+	k = (x * 1.44269504088896338700 + VEC_ROUND) - VEC_ROUND;
+	r = (x - k * VEC_LN2_HI) - k * VEC_LN2_LO;
+	p = 1.0 / 6227020800.0;
+	p = p * r + 1.0 / 479001600.0;
+	p = p * r + 1.0 / 39916800.0;
+	p = p * r + 1.0 / 3628800.0;
+	p = p * r + 1.0 / 362880.0;
+	p = p * r + 1.0 / 40320.0;
+	p = p * r + 1.0 / 5040.0;
+	p = p * r + 1.0 / 720.0;
+	p = p * r + 1.0 / 120.0;
+	p = p * r + 1.0 / 24.0;
+	p = p * r + 1.0 / 6.0;
+	p = p * r + 0.5;
+	p = p * r + 1.0;
+	p = p * r + 1.0;
+	scale.i = ((long long) k + 1023) << 52;
+	return p * scale.d;
+}
+
+/*
+ * Applies the fast kernel to the whole array when every argument is
+ * inside its range, which is the loop the compiler vectorizes;
+ * otherwise goes element by element and lets libm handle the rest.
+ */
+#define VEC_MAP(n, x, y, fast, slow, max)	do {			\
+		int __i, __big = 0;					\
+		for (__i = 0; __i < (n); __i++)				\
+			__big |= !(fabs((x)[__i]) < (max));		\
+		if (!__big) {						\
+			for (__i = 0; __i < (n); __i++)			\
+				(y)[__i] = fast((x)[__i]);		\
+			break;						\
+		}							\
+		for (__i = 0; __i < (n); __i++)				\
+			(y)[__i] = fabs((x)[__i]) < (max) ?		\
+				fast((x)[__i]) : slow((x)[__i]);	\
+	} while (0)
+
+/**
+ * vsin:
+ * @n : number of points
+ * @x : arguments
+ * @y : results, may be the same array as @x
+ *
+ * Computes y[i] = sin(x[i]).
+ *
+ * Modifies y.	No return value.
+ */
+static inline void vsin(int n, const double x[], double y[])
+{
+	VEC_MAP(n, x, y, vec_sin1, sin, VEC_TRIG_MAX);
+}
+
+/**
+ * vcos:
+ * @n : number of points
+ * @x : arguments
+ * @y : results, may be the same array as @x
+ *
+ * Computes y[i] = cos(x[i]).
+ *
+ * Modifies y.	No return value.
+ */
+static inline void vcos(int n, const double x[], double y[])
+{
+	VEC_MAP(n, x, y, vec_cos1, cos, VEC_TRIG_MAX);
+}
+
+/**
+ * vexp:
+ * @n : number of points
+ * @x : arguments
+ * @y : results, may be the same array as @x
+ *
+ * Computes y[i] = exp(x[i]).
+ *
+ * Modifies y.	No return value.
+ */
+static inline void vexp(int n, const double x[], double y[])
+{
+	VEC_MAP(n, x, y, vec_exp1, exp, VEC_EXP_MAX);
+}
+
+#endif /* VECMATH_H */
@@ -0,0 +1,105 @@
+/* Implements the bump allocator behind the _ws variants of the solvers
+ *
+ * Typical use: size a workspace once for the largest problem,
+ *
+ *	workspace_init(&ws, lsolve_sor_workspace(n));
+ *
+ * then pass it to lsolve_sor_ws() and friends as often as needed.
+ */
+
+#include <stdlib.h>
+#undef NDEBUG
+#include <assert.h>
+#include "workspace.h"
+
+/**
+ * workspace_init:
+ * @ws : workspace to initialize
+ * @size : bytes of scratch memory, as returned by the size queries
+ *
+ * Allocates the buffer of an empty workspace.  @size may be 0, the
+ * workspace can be grown later with workspace_reserve().
+ *
+ * Returns: 0 on success, -1 if out of memory
+ */
+int workspace_init(struct workspace *ws, size_t size)
+{
+	assert(ws != NULL);
+	ws->base = NULL;
+	ws->size = 0;
+	ws->used = 0;
+	ws->peak = 0;
+	return workspace_reserve(ws, size);
+}
+
+/**
+ * workspace_reserve:
+ * @ws : workspace, not in use by any solver
+ * @size : bytes needed
+ *
+ * Grows the buffer of @ws to at least @size bytes, so one workspace
+ * can be sized for several solvers by reserving each of their sizes.
+ * Never shrinks it.
+ *
+ * Returns: 0 on success, -1 if out of memory (@ws is left unchanged)
+ */
+int workspace_reserve(struct workspace *ws, size_t size)
+{
+	void *p;
+
+	assert(ws != NULL && ws->used == 0);
+	if (size <= ws->size)
+		return 0;
+	size = workspace_size(size, 1);
+	if (posix_memalign(&p, WORKSPACE_ALIGN, size))
+		return -1;
+	free(ws->base);
+	ws->base = p;
+	ws->size = size;
+	return 0;
+}
+
+/**
+ * workspace_destroy:
+ * @ws : workspace
+ *
+ * Frees the buffer of @ws.
+ *
+ * No return value.
+ */
+void workspace_destroy(struct workspace *ws)
+{
+	free(ws->base);
+	ws->base = NULL;
+	ws->size = 0;
+	ws->used = 0;
+}
+
+/**
+ * workspace_alloc:
+ * @ws : workspace
+ * @nmemb : number of objects
+ * @size : size of one object
+ *
+ * Takes workspace_size(@nmemb, @size) bytes from @ws, aligned to
+ * WORKSPACE_ALIGN.  The memory is not cleared.
+ *
+ * Returns: The block, NULL if @ws is too small
+ */
+void *workspace_alloc(struct workspace *ws, size_t nmemb, size_t size)
+{
+	size_t bytes;
+	void *p;
+
+	assert(ws != NULL);
+	if (size != 0 && nmemb > ((size_t) -1 - WORKSPACE_ALIGN) / size)
+		return NULL;
+	bytes = workspace_size(nmemb, size);
+	if (bytes > ws->size - ws->used)
+		return NULL;
+	p = ws->base + ws->used;
+	ws->used += bytes;
+	if (ws->used > ws->peak)
+		ws->peak = ws->used;
+	return p;
+}
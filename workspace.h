@@ -0,0 +1,48 @@
+/* Caller-owned scratch memory for the solvers, see workspace.c */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stddef.h>
+
+/* every block handed out starts on a cache line */
+#define WORKSPACE_ALIGN	64
+
+/*
+ * A bump allocator over one buffer.  Solvers take their scratch arrays
+ * from it and give them back on return, so a workspace sized once with
+ * the solver's size query can be reused for any number of calls without
+ * touching the heap.  A workspace must not be used by two threads at
+ * the same time; give every thread its own.
+ */
+struct workspace {
+	char *base;
+	size_t size;
+	size_t used;
+	size_t peak;	/* most bytes ever in use */
+};
+
+/* bytes taken by an array of @nmemb objects of @size bytes */
+static inline size_t workspace_size(size_t nmemb, size_t size)
+{
+	return (nmemb * size + WORKSPACE_ALIGN - 1)
+	       & ~(size_t) (WORKSPACE_ALIGN - 1);
+}
+
+int workspace_init(struct workspace *ws, size_t size);
+int workspace_reserve(struct workspace *ws, size_t size);
+void workspace_destroy(struct workspace *ws);
+void *workspace_alloc(struct workspace *ws, size_t nmemb, size_t size);
+
+/* for solvers: remember how much is in use, and give back all since */
+static inline size_t workspace_mark(const struct workspace *ws)
+{
+	return ws->used;
+}
+
+static inline void workspace_release(struct workspace *ws, size_t mark)
+{
+	ws->used = mark;
+}
+
+#endif /* WORKSPACE_H */